@@ -0,0 +1,152 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "ModbusConvert.hpp"
+#include "ModbusScaling.hpp"
+#include "ModbusUtils.hpp"
+
+namespace {
+    constexpr size_t BUFFER_REGISTERS = 16;
+
+    template<typename T>
+    T sampleValue() {
+        if constexpr (std::is_same_v<T, std::string>)
+            return "eModbus benchmark";
+        else if constexpr (std::is_same_v<T, std::vector<uint8_t>>)
+            return std::vector<uint8_t>(BUFFER_REGISTERS * 2 - 1, 0xA5);
+        else if constexpr (std::is_same_v<T, float>)
+            return 1234.5f;
+        else
+            return static_cast<T>(0x5A5A5A5A);
+    }
+}
+
+template<typename T, eModbus::ByteOrder Order = eModbus::ByteOrder::MSB>
+static void BM_ConvertFromRegisters(benchmark::State &state) {
+    std::array<uint16_t, BUFFER_REGISTERS> registers{};
+    eModbus::convertToRegisters<T, Order>(registers, sampleValue<T>());
+    for (auto _: state) {
+        benchmark::DoNotOptimize(registers);
+        benchmark::DoNotOptimize(eModbus::convertFromRegisters<T, Order>(registers));
+    }
+}
+
+template<typename T, eModbus::ByteOrder Order = eModbus::ByteOrder::MSB>
+static void BM_ConvertToRegisters(benchmark::State &state) {
+    std::array<uint16_t, BUFFER_REGISTERS> registers{};
+    const T value = sampleValue<T>();
+    for (auto _: state) {
+        eModbus::convertToRegisters<T, Order>(registers, value);
+        benchmark::DoNotOptimize(registers);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_ConvertFromRegisters, uint16_t);
+BENCHMARK_TEMPLATE(BM_ConvertFromRegisters, uint32_t);
+BENCHMARK_TEMPLATE(BM_ConvertFromRegisters, float);
+BENCHMARK_TEMPLATE(BM_ConvertFromRegisters, uint8_t, eModbus::ByteOrder::MSB);
+BENCHMARK_TEMPLATE(BM_ConvertFromRegisters, uint8_t, eModbus::ByteOrder::LSB);
+BENCHMARK_TEMPLATE(BM_ConvertFromRegisters, std::string);
+BENCHMARK_TEMPLATE(BM_ConvertFromRegisters, std::vector<uint8_t>);
+
+BENCHMARK_TEMPLATE(BM_ConvertToRegisters, uint16_t);
+BENCHMARK_TEMPLATE(BM_ConvertToRegisters, uint32_t);
+BENCHMARK_TEMPLATE(BM_ConvertToRegisters, float);
+BENCHMARK_TEMPLATE(BM_ConvertToRegisters, uint8_t, eModbus::ByteOrder::MSB);
+BENCHMARK_TEMPLATE(BM_ConvertToRegisters, uint8_t, eModbus::ByteOrder::LSB);
+BENCHMARK_TEMPLATE(BM_ConvertToRegisters, std::string);
+BENCHMARK_TEMPLATE(BM_ConvertToRegisters, std::vector<uint8_t>);
+
+template<typename T, eModbus::WordOrder Order>
+static void BM_BulkFromRegisters(benchmark::State &state) {
+    std::array<uint16_t, eModbus::MAX_MODBUS_REGISTERS> registers{};
+    for (size_t i = 0; i < registers.size(); ++i)
+        registers[i] = static_cast<uint16_t>(i * 0x0101);
+    std::array<T, eModbus::MAX_MODBUS_REGISTERS / (sizeof(T) / 2)> values{};
+    for (auto _: state) {
+        benchmark::DoNotOptimize(registers);
+        benchmark::DoNotOptimize(eModbus::bulkFromRegisters<T, Order>(registers, values));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * values.size()));
+}
+
+template<typename T, eModbus::WordOrder Order>
+static void BM_BulkToRegisters(benchmark::State &state) {
+    std::array<T, eModbus::MAX_MODBUS_REGISTERS / (sizeof(T) / 2)> values{};
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<T>(i * 3);
+    std::array<uint16_t, eModbus::MAX_MODBUS_REGISTERS> registers{};
+    for (auto _: state) {
+        benchmark::DoNotOptimize(values);
+        benchmark::DoNotOptimize(eModbus::bulkToRegisters<T, Order>(std::span<const T>(values), registers));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * values.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_BulkFromRegisters, int16_t, eModbus::WordOrder::BADC);
+BENCHMARK_TEMPLATE(BM_BulkFromRegisters, uint32_t, eModbus::WordOrder::ABCD);
+BENCHMARK_TEMPLATE(BM_BulkFromRegisters, float, eModbus::WordOrder::ABCD);
+BENCHMARK_TEMPLATE(BM_BulkFromRegisters, float, eModbus::WordOrder::CDAB);
+BENCHMARK_TEMPLATE(BM_BulkFromRegisters, float, eModbus::WordOrder::BADC);
+BENCHMARK_TEMPLATE(BM_BulkFromRegisters, float, eModbus::WordOrder::DCBA);
+BENCHMARK_TEMPLATE(BM_BulkFromRegisters, int64_t, eModbus::WordOrder::ABCD);
+BENCHMARK_TEMPLATE(BM_BulkFromRegisters, double, eModbus::WordOrder::CDAB);
+
+BENCHMARK_TEMPLATE(BM_BulkToRegisters, float, eModbus::WordOrder::ABCD);
+BENCHMARK_TEMPLATE(BM_BulkToRegisters, float, eModbus::WordOrder::CDAB);
+BENCHMARK_TEMPLATE(BM_BulkToRegisters, double, eModbus::WordOrder::DCBA);
+
+static void BM_ScalingPlanDecode(benchmark::State &state) {
+    // a full holding register block of mixed tags: U16 with one decimal, U32, FLOAT with limits, U8 halves
+    std::vector<eModbus::Tag> tags;
+    for (uint16_t address = 0; address + 2 <= eModbus::MAX_MODBUS_REGISTERS;) {
+        eModbus::Tag &tag = tags.emplace_back();
+        tag.register_type = eModbus::RegisterType::Holding;
+        tag.register_number = address;
+        tag.precision = 1;
+        tag.min_value = 0;
+        tag.max_value = 0;
+        switch (tags.size() % 4) {
+            case 0:
+                tag.register_value_type = eModbus::Tag::modbus_parameter_type::U16;
+                address += 1;
+                break;
+            case 1:
+                tag.register_value_type = eModbus::Tag::modbus_parameter_type::U32;
+                address += 2;
+                break;
+            case 2:
+                tag.register_value_type = eModbus::Tag::modbus_parameter_type::FLOAT;
+                tag.min_value = -100;
+                tag.max_value = 100;
+                address += 2;
+                break;
+            default:
+                tag.register_value_type = eModbus::Tag::modbus_parameter_type::U8_MSB;
+                address += 1;
+                break;
+        }
+    }
+    const eModbus::ScalingPlan plan(0, eModbus::RegisterType::Holding, eModbus::MAX_MODBUS_REGISTERS, tags);
+    std::array<uint16_t, eModbus::MAX_MODBUS_REGISTERS> registers{};
+    for (size_t i = 0; i < registers.size(); ++i)
+        registers[i] = static_cast<uint16_t>(i * 0x0301);
+    std::vector<double> values(tags.size());
+    std::vector<uint8_t> flags(tags.size());
+    for (auto _: state) {
+        benchmark::DoNotOptimize(registers);
+        plan.decode(registers, values, flags);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tags.size()));
+}
+
+BENCHMARK(BM_ScalingPlanDecode);
@@ -0,0 +1,99 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+#include <vector>
+
+#include "ModbusFrame.hpp"
+#include "ModbusFramePool.hpp"
+#include "ModbusUtils.hpp"
+
+namespace {
+    std::vector<uint8_t> payload(const size_t size) {
+        std::vector<uint8_t> result(size);
+        std::iota(result.begin(), result.end(), uint8_t{1});
+        return result;
+    }
+
+    std::vector<uint16_t> registers(const size_t count) {
+        std::vector<uint16_t> result(count);
+        std::iota(result.begin(), result.end(), uint16_t{0x1234});
+        return result;
+    }
+
+    eModbus::Frame readResponse(const uint16_t quantity) {
+        std::vector<uint16_t> values = registers(quantity);
+        return eModbus::Frame::build(false, 1, eModbus::Frame::ReadHoldingRegisters, 0, quantity, values);
+    }
+}
+
+static void BM_CalculateModbusCRC(benchmark::State &state) {
+    const std::vector<uint8_t> data = payload(static_cast<size_t>(state.range(0)));
+    for (auto _: state)
+        benchmark::DoNotOptimize(eModbus::Frame::calculateModbusCRC(data));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BM_CalculateModbusCRC)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_FrameBuildReadRequest(benchmark::State &state) {
+    for (auto _: state) {
+        eModbus::Frame frame = eModbus::Frame::build(true, 1, eModbus::Frame::ReadHoldingRegisters, 100, 10);
+        benchmark::DoNotOptimize(frame);
+    }
+}
+
+BENCHMARK(BM_FrameBuildReadRequest);
+
+static void BM_FrameBuildWriteRequest(benchmark::State &state) {
+    std::vector<uint16_t> values = registers(static_cast<size_t>(state.range(0)));
+    for (auto _: state) {
+        eModbus::Frame frame = eModbus::Frame::build(true, 1, eModbus::Frame::WriteMultipleRegisters, 100,
+                                                     static_cast<uint16_t>(values.size()), values);
+        benchmark::DoNotOptimize(frame);
+    }
+}
+
+BENCHMARK(BM_FrameBuildWriteRequest)->Arg(1)->Arg(16)->Arg(eModbus::MAX_MODBUS_REGISTERS - 2);
+
+static void BM_FrameRebuild(benchmark::State &state) {
+    eModbus::Frame frame;
+    uint16_t address = 0;
+    for (auto _: state) {
+        frame.rebuild(true, 1, eModbus::Frame::ReadHoldingRegisters, address++, 10);
+        benchmark::DoNotOptimize(frame);
+    }
+}
+
+BENCHMARK(BM_FrameRebuild);
+
+static void BM_FramePoolAcquireRebuild(benchmark::State &state) {
+    static eModbus::FramePool<256> pool;
+    uint16_t address = 0;
+    for (auto _: state) {
+        eModbus::FramePool<256>::Handle frame = pool.acquire();
+        frame->rebuild(true, 1, eModbus::Frame::ReadHoldingRegisters, address++, 10);
+        benchmark::DoNotOptimize(frame.get());
+    }
+}
+
+BENCHMARK(BM_FramePoolAcquireRebuild);
+
+static void BM_ValidateRTU(benchmark::State &state) {
+    const eModbus::Frame frame = readResponse(static_cast<uint16_t>(state.range(0)));
+    for (auto _: state)
+        benchmark::DoNotOptimize(frame.validateRTU());
+}
+
+BENCHMARK(BM_ValidateRTU)->Arg(1)->Arg(16)->Arg(eModbus::MAX_MODBUS_REGISTERS);
+
+static void BM_RegistersValues(benchmark::State &state) {
+    eModbus::Frame frame = readResponse(static_cast<uint16_t>(state.range(0)));
+    for (auto _: state)
+        benchmark::DoNotOptimize(frame.registersValues());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BM_RegistersValues)->Arg(1)->Arg(16)->Arg(eModbus::MAX_MODBUS_REGISTERS);
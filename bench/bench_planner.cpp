@@ -0,0 +1,106 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ModbusMasterTag.hpp"
+#include "ModbusSimulatedBus.hpp"
+
+namespace {
+    /**
+     * Synthetic tag map: tags spread over the four register types, 1-4 registers long, mostly packed with
+     * occasional gaps, like a device parameter table.
+     */
+    std::vector<eModbus::Tag> syntheticTags(const size_t count) {
+        std::mt19937 random{42};
+        std::vector<eModbus::Tag> tags(count);
+        std::array<uint16_t, 4> next_address{};
+        for (size_t i = 0; i < count; ++i) {
+            eModbus::Tag &tag = tags[i];
+            const auto register_type = static_cast<eModbus::RegisterType>(random() % 4);
+            uint16_t &address = next_address[static_cast<int>(register_type)];
+            if (random() % 8 == 0)
+                address = static_cast<uint16_t>(address + random() % 32);
+            tag.key = "tag" + std::to_string(i);
+            tag.register_type = register_type;
+            tag.register_number = address;
+            tag.register_length = static_cast<uint16_t>(1 + random() % 4);
+            address = static_cast<uint16_t>(address + tag.register_length);
+        }
+        return tags;
+    }
+}
+
+static void BM_PrepareReadRequestsByID(benchmark::State &state) {
+    eModbus::SimulatedBus bus;
+    eModbus::MasterTag master = eModbus::MasterTag::RTU(bus);
+    const std::vector<eModbus::Tag> tags = syntheticTags(static_cast<size_t>(state.range(0)));
+    master.registerTags(tags);
+    std::vector<eModbus::MasterTag::TagID> ids;
+    ids.reserve(tags.size());
+    for (const eModbus::Tag &tag: tags)
+        ids.push_back(tag.key);
+
+    for (auto _: state)
+        benchmark::DoNotOptimize(master.prepareReadRequests(std::span(ids)));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BM_PrepareReadRequestsByID)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMicrosecond);
+
+static void BM_PrepareReadRequestsByHandle(benchmark::State &state) {
+    eModbus::SimulatedBus bus;
+    eModbus::MasterTag master = eModbus::MasterTag::RTU(bus);
+    const std::vector<eModbus::Tag> tags = syntheticTags(static_cast<size_t>(state.range(0)));
+    master.registerTags(tags);
+    std::vector<eModbus::MasterTag::TagID> ids;
+    ids.reserve(tags.size());
+    for (const eModbus::Tag &tag: tags)
+        ids.push_back(tag.key);
+    std::vector<eModbus::MasterTag::TagHandle> handles = master.handles(ids);
+    std::ranges::sort(handles);
+
+    for (auto _: state)
+        benchmark::DoNotOptimize(master.prepareReadRequests(std::span<const eModbus::MasterTag::TagHandle>(handles)));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BM_PrepareReadRequestsByHandle)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMicrosecond);
+
+static void BM_PrepareReadRequestsByRef(benchmark::State &state) {
+    eModbus::SimulatedBus bus;
+    const eModbus::MasterTag master = eModbus::MasterTag::RTU(bus);
+    const std::vector<eModbus::Tag> tags = syntheticTags(static_cast<size_t>(state.range(0)));
+    const std::vector<eModbus::MasterTag::TagRef> refs(tags.begin(), tags.end());
+
+    for (auto _: state)
+        benchmark::DoNotOptimize(master.prepareReadRequests(std::span(refs)));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BM_PrepareReadRequestsByRef)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMicrosecond);
+
+static void BM_ReadPlanCached(benchmark::State &state) {
+    eModbus::SimulatedBus bus;
+    eModbus::MasterTag master = eModbus::MasterTag::RTU(bus);
+    const std::vector<eModbus::Tag> tags = syntheticTags(static_cast<size_t>(state.range(0)));
+    master.registerTags(tags);
+    std::vector<eModbus::MasterTag::TagID> ids;
+    ids.reserve(tags.size());
+    for (const eModbus::Tag &tag: tags)
+        ids.push_back(tag.key);
+    const std::vector<eModbus::MasterTag::TagHandle> handles = master.handles(ids);
+    master.readPlan(1, handles);
+
+    // what a poll cycle pays before sending: fingerprint and compare the tag set, no planning
+    for (auto _: state)
+        benchmark::DoNotOptimize(&master.readPlan(1, handles));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BM_ReadPlanCached)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMicrosecond);
@@ -8,10 +8,14 @@
 #ifndef INC_ISTREAMDEVICE_HPP_
 #define INC_ISTREAMDEVICE_HPP_
 #include <inttypes.h>
+#include <chrono>
 #include <span>
 #include <functional>
 #include <string>
 #include <string_view>
+#include <thread>
+
+#include "ModbusByteRing.hpp"
 /**
  * @brief Defines common error codes for serial operations.
  */
@@ -23,11 +27,13 @@ enum class SerialError : uint8_t {
     BUSY,
     BUFFER_TOO_SMALL,
     INVALID_ARGUMENT,
+    WOULD_BLOCK,
     // Add more specific errors as needed
     UNKNOWN_ERROR
 };
 
-inline std::string to_string(SerialError error) {
+/** @brief Name of the error as a static string, usable where allocating is not (exceptions, ISRs). */
+constexpr const char *to_c_string(SerialError error) {
     switch (error) {
         case SerialError::SUCCESS: return "SUCCESS";
         case SerialError::TIMEOUT: return "TIMEOUT";
@@ -36,16 +42,27 @@ inline std::string to_string(SerialError error) {
         case SerialError::BUSY: return "BUSY";
         case SerialError::BUFFER_TOO_SMALL: return "BUFFER_TOO_SMALL";
         case SerialError::INVALID_ARGUMENT: return "INVALID_ARGUMENT";
+        case SerialError::WOULD_BLOCK: return "WOULD_BLOCK";
         default:
         case SerialError::UNKNOWN_ERROR: return "UNKNOWN_ERROR";
     }
 }
 
+inline std::string to_string(SerialError error) {
+    return to_c_string(error);
+}
+
 
 class IStreamDevice {
 protected:
     std::function<void(std::span<uint8_t> received_data)> rxCompleteCallback;
     std::function<void()> txCompleteCallback;
+    /**
+     * Optional receive ring. When set, drivers write incoming bytes straight into it (rxRing->prepareWrite() as
+     * DMA/callback target, then rxRing->commitWrite(size) in onRxComplete) instead of a private staging buffer,
+     * and the parser reads them in place through rxRing->readable().
+     */
+    eModbus::ByteRing* rxRing = nullptr;
 
 public:
     /**
@@ -76,6 +93,105 @@ public:
      * @return SerialError indicating success or the type of error.
      */
     virtual SerialError write(std::span<const uint8_t> buffer, uint32_t timeout_ms, size_t* bytes_written_out = nullptr) = 0;
+
+    /**
+     * @brief Writes several buffers as one transmission (scatter-gather), e.g. MBAP header + PDU or a batch of frames.
+     * Drivers that can gather (writev, chained DMA descriptors) should override it, so that the data leaves in one
+     * syscall/transfer without being copied into one contiguous buffer first.
+     * The default implementation writes the buffers one after another, each with timeout_ms.
+     *
+     * @param buffers The buffers to write, in order.
+     * @param timeout_ms The maximum time to wait for write completion of every buffer in milliseconds.
+     * @param bytes_written_out Pointer to a variable to store the total number of bytes written.
+     * @return SerialError indicating success or the type of error.
+     */
+    virtual SerialError writev(std::span<const std::span<const uint8_t>> buffers, uint32_t timeout_ms,
+                               size_t* bytes_written_out = nullptr) {
+        size_t total = 0;
+        SerialError err = SerialError::SUCCESS;
+        for (const auto& buffer : buffers) {
+            size_t written = 0;
+            err = write(buffer, timeout_ms, &written);
+            total += written;
+            if (err != SerialError::SUCCESS)
+                break;
+        }
+        if (bytes_written_out)
+            *bytes_written_out = total;
+        return err;
+    }
+
+    /**
+     * @brief Reads whatever is already received, without blocking.
+     * The default implementation copies from rxRing when one is set, otherwise it calls read() with zero timeout.
+     *
+     * @param buffer The buffer to store the read data.
+     * @param bytes_read_out Pointer to a variable to store the actual number of bytes read.
+     * @return SerialError::SUCCESS if the buffer was filled, SerialError::WOULD_BLOCK if less data was available.
+     */
+    virtual SerialError tryRead(std::span<uint8_t> buffer, size_t* bytes_read_out = nullptr) {
+        if (rxRing) {
+            const eModbus::ByteRing::Segments received = rxRing->readable();
+            const size_t copied = received.copyTo(buffer);
+            rxRing->consume(copied);
+            if (bytes_read_out)
+                *bytes_read_out = copied;
+            return copied == buffer.size() ? SerialError::SUCCESS : SerialError::WOULD_BLOCK;
+        }
+        size_t read_count = 0;
+        const SerialError err = read(buffer, 0, &read_count);
+        if (bytes_read_out)
+            *bytes_read_out = read_count;
+        return err == SerialError::TIMEOUT ? SerialError::WOULD_BLOCK : err;
+    }
+
+    /**
+     * @brief Number of received bytes that tryRead() can return immediately, 0 when unknown.
+     */
+    virtual size_t bytesAvailable() const {
+        return rxRing ? rxRing->size() : 0;
+    }
+
+    virtual void setRxRing(eModbus::ByteRing* ring) {
+        rxRing = ring;
+    }
+
+    eModbus::ByteRing* rxBuffer() const {
+        return rxRing;
+    }
+
+    static constexpr int InvalidHandle = -1;
+    /**
+     * @brief OS handle (file descriptor) that becomes readable when data arrives, so that a reactor
+     * (epoll/poll/select) can wait on many devices at once. InvalidHandle if the device has none.
+     */
+    virtual int nativeHandle() const {
+        return InvalidHandle;
+    }
+    /**
+     * @brief Keeps the line silent for delay_us before the next write (the rest of t3.5 after the last frame).
+     * Masters call it right before sending, so the request leaves as early as the spec allows.
+     * t3.5 is 4 ms at 9600 baud and 32 ms at 1200, more than a sleep's wake-up latency, so the default sleeps
+     * until SpinTail_us before the deadline and spins only that rest on steady_clock.
+     * Drivers with a hardware timer, an RTOS delay or virtual time override it.
+     */
+    virtual void interFrameDelay(const uint32_t delay_us) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(delay_us);
+        if (delay_us > SpinTail_us)
+            std::this_thread::sleep_until(deadline - std::chrono::microseconds(SpinTail_us));
+        while (std::chrono::steady_clock::now() < deadline) {
+        }
+    }
+    /** part of interFrameDelay() spun instead of slept, about the wake-up latency of a desktop scheduler */
+    static constexpr uint32_t SpinTail_us = 1000;
+    /**
+     * @brief Waits delay_us without holding the CPU, e.g. a retry backoff of milliseconds. Unlike interFrameDelay()
+     * it does not care about sub-millisecond precision. Drivers on an RTOS or virtual time override it.
+     */
+    virtual void delay(const uint32_t delay_us) {
+        std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+    }
+
     static constexpr uint32_t InvalidBaudrate = 0;
     virtual void baudrate(uint32_t baudrate) {
     }
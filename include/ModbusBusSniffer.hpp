@@ -0,0 +1,118 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSBUSSNIFFER_HPP
+#define MODBUSBUSSNIFFER_HPP
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
+
+#include "IStreamDevice.hpp"
+#include "ModbusByteRing.hpp"
+#include "ModbusFrame.hpp"
+#include "ModbusRegisterImage.hpp"
+#include "ModbusUtils.hpp"
+
+namespace eModbus {
+    /**
+     * @brief Listen-only RTU decoder for a bus that another master already polls. It never transmits.
+     *
+     * Received bytes go into the sniffer's ring (attach() makes the device write into it directly, or feed() them).
+     * process() cuts frames out of the ring by the length their first bytes announce and their CRC, validated in
+     * place. It pairs every request with the response that follows and puts the values into a register image per
+     * slave: read responses, write single echoes and write multiple requests that were acknowledged.
+     * Garbage and corrupted frames are skipped until the stream lines up with a valid frame again.
+     *
+     * The ring may be filled from a driver thread, process() and the image accessors belong to one consumer thread.
+     */
+    class BusSniffer {
+    public:
+        static constexpr size_t RingCapacity = 1024;
+
+        struct Statistics {
+            uint64_t requests = 0;
+            uint64_t responses = 0;
+            uint64_t exceptions = 0;
+            /** frames whose length was plausible but whose CRC was not */
+            uint64_t crcErrors = 0;
+            /** requests without a response and responses without a request */
+            uint64_t unmatched = 0;
+            uint64_t bytesSkipped = 0;
+        };
+
+        struct SlaveImage {
+            /** everything seen so far; values that changed are marked dirty until the owner clears them */
+            RegisterImage registers;
+            uint64_t updates = 0;
+            std::chrono::steady_clock::time_point lastUpdate{};
+        };
+
+        /** slave, register type, first address and count of the values that were just updated */
+        using UpdateCallback = std::function<void(uint8_t slave_ID, RegisterType register_type,
+                                                  uint16_t start_address, uint16_t quantity)>;
+
+        BusSniffer() = default;
+        BusSniffer(const BusSniffer &) = delete;
+        BusSniffer &operator=(const BusSniffer &) = delete;
+
+        /** @brief Makes the device's driver write received bytes straight into the sniffer's ring. */
+        void attach(IStreamDevice &device) {
+            device.setRxRing(&_ring);
+        }
+
+        /** @brief Copies a chunk of received bytes into the ring and processes it. @return frames decoded */
+        size_t feed(std::span<const uint8_t> data);
+
+        /** @brief Decodes the complete frames in the ring. @return frames decoded */
+        size_t process();
+
+        std::optional<uint16_t> get(uint8_t slave_ID, RegisterType register_type, uint16_t address) const;
+
+        /** @brief Copies values.size() values from start_address on. @return false if any of them was not seen yet */
+        bool read(uint8_t slave_ID, RegisterType register_type, uint16_t start_address,
+                  std::span<uint16_t> values) const;
+
+        const SlaveImage *slave(uint8_t slave_ID) const {
+            const auto it = _slaves.find(slave_ID);
+            return it == _slaves.end() ? nullptr : &it->second;
+        }
+
+        const std::map<uint8_t, SlaveImage> &slaves() const {
+            return _slaves;
+        }
+
+        void onUpdate(UpdateCallback callback) {
+            _onUpdate = std::move(callback);
+        }
+
+        const Statistics &statistics() const {
+            return _statistics;
+        }
+
+        /** @brief Forgets the image, the statistics and any half received frame. */
+        void reset();
+
+    private:
+        StaticByteRing<RingCapacity> _ring;
+        std::map<uint8_t, SlaveImage> _slaves;
+        Statistics _statistics;
+        UpdateCallback _onUpdate;
+        /** last request still waiting for its response */
+        Frame _request;
+        bool _pending = false;
+        Frame _response;
+
+        void handleRequest(const ByteRing::Segments &adu);
+
+        void handleResponse(const ByteRing::Segments &adu);
+
+        void updated(uint8_t slave_ID, SlaveImage &image, RegisterType register_type, uint16_t start_address,
+                     uint16_t quantity);
+    };
+}
+
+#endif //MODBUSBUSSNIFFER_HPP
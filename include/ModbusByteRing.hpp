@@ -0,0 +1,173 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSBYTERING_HPP
+#define MODBUSBYTERING_HPP
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+
+namespace eModbus {
+    /**
+     * @brief Single producer / single consumer byte ring for the RX path of stream devices.
+     *
+     * The producer is the driver (rx callback, interrupt or DMA), the consumer is the frame parser.
+     * Capacity is a power of two, so indices run freely and are masked on access. Head and tail live on separate
+     * cache lines, so the producer and the consumer do not fight over one line.
+     *
+     * Both sides work on spans straight in the ring memory: prepareWrite()/commitWrite() lets DMA write in place,
+     * readable()/consume() lets the parser read without copying. A wrapped region is exposed as two spans.
+     */
+    class ByteRing {
+    public:
+        static constexpr size_t CacheLineSize = 64;
+
+        template<typename T>
+        struct BasicSegments {
+            std::span<T> first;
+            std::span<T> second;
+
+            constexpr size_t size() const {
+                return first.size() + second.size();
+            }
+
+            constexpr bool empty() const {
+                return size() == 0;
+            }
+
+            constexpr T &operator[](const size_t index) const {
+                return index < first.size() ? first[index] : second[index - first.size()];
+            }
+
+            constexpr BasicSegments subspan(const size_t offset, size_t count) const {
+                count = std::min(count, size() - std::min(offset, size()));
+                if (offset >= first.size())
+                    return {second.subspan(offset - first.size(), count), {}};
+                const size_t first_count = std::min(count, first.size() - offset);
+                return {first.subspan(offset, first_count), second.first(count - first_count)};
+            }
+
+            /** @return true when the data does not wrap and first alone holds everything */
+            constexpr bool contiguous() const {
+                return second.empty();
+            }
+
+            size_t copyTo(std::span<uint8_t> destination) const {
+                const size_t first_count = std::min(first.size(), destination.size());
+                std::memcpy(destination.data(), first.data(), first_count);
+                const size_t second_count = std::min(second.size(), destination.size() - first_count);
+                std::memcpy(destination.data() + first_count, second.data(), second_count);
+                return first_count + second_count;
+            }
+        };
+
+        using Segments = BasicSegments<const uint8_t>;
+        using WriteSegments = BasicSegments<uint8_t>;
+
+        explicit ByteRing(const std::span<uint8_t> storage)
+            : storage_{storage}, mask_{storage.size() - 1} {
+            if (!std::has_single_bit(storage.size()))
+                throw std::invalid_argument("Ring capacity must be a power of two");
+        }
+
+        ByteRing(const ByteRing &) = delete;
+        ByteRing &operator=(const ByteRing &) = delete;
+
+        size_t capacity() const {
+            return storage_.size();
+        }
+
+        // --- producer side ---
+
+        /** @brief Free space as (up to) two spans, fill them and then call commitWrite(). */
+        WriteSegments prepareWrite() {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            const size_t tail = tail_.load(std::memory_order_acquire);
+            return segments<uint8_t>(head, capacity() - (head - tail));
+        }
+
+        void commitWrite(const size_t count) {
+            head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+
+        /** @brief Copies as much of data as fits. @return number of bytes written */
+        size_t push(const std::span<const uint8_t> data) {
+            const WriteSegments free_space = prepareWrite();
+            const size_t count = std::min(data.size(), free_space.size());
+            const size_t first_count = std::min(count, free_space.first.size());
+            std::memcpy(free_space.first.data(), data.data(), first_count);
+            std::memcpy(free_space.second.data(), data.data() + first_count, count - first_count);
+            commitWrite(count);
+            return count;
+        }
+
+        // --- consumer side ---
+
+        /** @brief Received data as (up to) two spans, valid until consume(). */
+        Segments readable() {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            return segments<const uint8_t>(tail, cachedHead_ - tail);
+        }
+
+        void consume(const size_t count) {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            tail_.store(tail + std::min(count, cachedHead_ - tail), std::memory_order_release);
+        }
+
+        /** @brief Drops everything received so far. Consumer side only. */
+        void clear() {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            tail_.store(cachedHead_, std::memory_order_release);
+        }
+
+        /** @brief Approximate number of bytes ready to read, exact when called from the consumer. */
+        size_t size() const {
+            return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::span<uint8_t> storage_;
+        size_t mask_;
+
+        alignas(CacheLineSize) std::atomic<size_t> head_{0};
+
+        alignas(CacheLineSize) std::atomic<size_t> tail_{0};
+        size_t cachedHead_ = 0; // consumer's copy of head_
+
+        template<typename T>
+        BasicSegments<T> segments(const size_t position, const size_t count) const {
+            const size_t offset = position & mask_;
+            const size_t first_count = std::min(count, capacity() - offset);
+            return {
+                std::span<T>(storage_.data() + offset, first_count),
+                std::span<T>(storage_.data(), count - first_count)
+            };
+        }
+    };
+
+    namespace detail {
+        template<size_t Capacity>
+        struct ByteRingStorage {
+            alignas(ByteRing::CacheLineSize) std::array<uint8_t, Capacity> ringStorage_{};
+        };
+    }
+
+    /** @brief ByteRing with inline storage, for statically allocated driver buffers. */
+    template<size_t Capacity>
+    class StaticByteRing : private detail::ByteRingStorage<Capacity>, public ByteRing {
+        static_assert(std::has_single_bit(Capacity), "Ring capacity must be a power of two");
+
+    public:
+        StaticByteRing() : ByteRing(this->ringStorage_) {
+        }
+    };
+}
+
+#endif //MODBUSBYTERING_HPP
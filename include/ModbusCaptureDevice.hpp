@@ -0,0 +1,208 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSCAPTUREDEVICE_HPP
+#define MODBUSCAPTUREDEVICE_HPP
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "IStreamDevice.hpp"
+
+namespace eModbus {
+    /**
+     * Capture file layout (all fields little endian):
+     *   header:  "EMBCAP01" | uint64 used bytes (header included)
+     *   records: uint64 timestamp [ns since start] | uint8 direction | uint8 SerialError | uint16 length | data
+     * Records are appended back to back. The file is memory mapped and grows in chunks, the used size in the header
+     * is updated after each record, so a capture cut short by a crash is still readable up to the last record.
+     */
+    namespace capture {
+        enum class Direction : uint8_t {
+            Write = 0,
+            Read = 1,
+            Baudrate = 2, // data holds the new uint32 baud rate
+        };
+
+        struct Record {
+            uint64_t timestamp_ns;
+            Direction direction;
+            SerialError status;
+            std::span<const uint8_t> data;
+        };
+
+        constexpr char Magic[8] = {'E', 'M', 'B', 'C', 'A', 'P', '0', '1'};
+        constexpr size_t HeaderSize = 16;
+        constexpr size_t RecordHeaderSize = 12;
+
+        /** @brief Read-only, zero-copy view of a capture file. Record data points into the mapping. */
+        class Reader {
+        public:
+            explicit Reader(const std::string &path);
+            ~Reader();
+            Reader(const Reader &) = delete;
+            Reader &operator=(const Reader &) = delete;
+
+            std::optional<Record> next();
+
+            std::optional<Record> peek() const;
+
+            void rewind() {
+                position_ = HeaderSize;
+            }
+
+            /** @brief Size of the recorded data in bytes, header included. */
+            size_t size() const {
+                return used_;
+            }
+
+        private:
+            const uint8_t *data_ = nullptr;
+            size_t mapped_ = 0;
+            size_t used_ = 0;
+            size_t position_ = HeaderSize;
+
+            std::optional<Record> parse(size_t position, size_t *next_position) const;
+        };
+    }
+
+    /**
+     * @brief Decorator that forwards everything to another IStreamDevice and appends each write/read chunk,
+     * with its timestamp and result, to a memory-mapped capture file. Recording is a memcpy into the mapping,
+     * the file is written back by the kernel.
+     */
+    class RecordingStreamDevice : public IStreamDevice {
+    public:
+        RecordingStreamDevice(IStreamDevice &device, const std::string &path, size_t initial_capacity = 16 << 20);
+        ~RecordingStreamDevice() override;
+        RecordingStreamDevice(const RecordingStreamDevice &) = delete;
+        RecordingStreamDevice &operator=(const RecordingStreamDevice &) = delete;
+
+        SerialError read(std::span<uint8_t> buffer, uint32_t timeout_ms, size_t *bytes_read_out = nullptr) override;
+
+        SerialError write(std::span<const uint8_t> buffer, uint32_t timeout_ms,
+                          size_t *bytes_written_out = nullptr) override;
+
+        SerialError flush() override {
+            return _device.flush();
+        }
+
+        void baudrate(uint32_t baudrate) override;
+
+        uint32_t baudrate() const override {
+            return _device.baudrate();
+        }
+
+        void interFrameDelay(const uint32_t delay_us) override {
+            _device.interFrameDelay(delay_us);
+        }
+
+        void delay(const uint32_t delay_us) override {
+            _device.delay(delay_us);
+        }
+
+        void setOnTxCompleteCallback(std::function<void()> callback) override {
+            _device.setOnTxCompleteCallback(std::move(callback));
+        }
+
+        void setOnRxCompleteCallback(std::function<void(std::span<uint8_t> received_data)> callback) override {
+            _device.setOnRxCompleteCallback(std::move(callback));
+        }
+
+        /** @brief Number of records dropped because the capture file could not grow. */
+        uint64_t droppedRecords() const {
+            return _dropped;
+        }
+
+    private:
+        IStreamDevice &_device;
+        int _fd = -1;
+        uint8_t *_data = nullptr;
+        size_t _capacity = 0;
+        size_t _used = capture::HeaderSize;
+        uint64_t _dropped = 0;
+        std::chrono::steady_clock::time_point _start;
+
+        void append(capture::Direction direction, SerialError status, std::span<const uint8_t> data);
+
+        void appendBaudrate(uint32_t baudrate);
+
+        bool grow(size_t required);
+
+        void onTxComplete() override {
+        }
+
+        void onRxComplete(uint16_t size) override {
+        }
+    };
+
+    /**
+     * @brief Plays a capture back as an IStreamDevice: write() consumes the next recorded write,
+     * read() returns the next recorded read (data and result), baudrate() reports the recorded baud rate.
+     * With speed > 0 every record is held back until its original time divided by speed,
+     * with speed == 0 the capture runs as fast as possible.
+     */
+    class ReplayStreamDevice : public IStreamDevice {
+    public:
+        explicit ReplayStreamDevice(const std::string &path, double speed = 1.0);
+
+        SerialError read(std::span<uint8_t> buffer, uint32_t timeout_ms, size_t *bytes_read_out = nullptr) override;
+
+        SerialError write(std::span<const uint8_t> buffer, uint32_t timeout_ms,
+                          size_t *bytes_written_out = nullptr) override;
+
+        SerialError flush() override {
+            return SerialError::SUCCESS;
+        }
+
+        void baudrate(const uint32_t baudrate) override {
+            _baudrate = baudrate;
+        }
+
+        /** the recorded timestamps already contain the gaps and the waits */
+        void interFrameDelay(uint32_t) override {
+        }
+
+        void delay(uint32_t) override {
+        }
+
+        uint32_t baudrate() const override {
+            return _baudrate;
+        }
+
+        /** @brief Writes whose bytes differed from the recording. */
+        uint64_t mismatchedWrites() const {
+            return _mismatched;
+        }
+
+        bool finished() const {
+            return !_reader.peek().has_value();
+        }
+
+        void rewind();
+
+    private:
+        capture::Reader _reader;
+        double _speed;
+        uint32_t _baudrate = InvalidBaudrate;
+        uint64_t _mismatched = 0;
+        std::optional<uint64_t> _firstTimestamp_ns;
+        std::chrono::steady_clock::time_point _start;
+
+        void waitFor(uint64_t timestamp_ns);
+
+        /** @brief Skips baud rate records, remembering the last one. */
+        std::optional<capture::Record> peekTransfer();
+
+        void onTxComplete() override {
+        }
+
+        void onRxComplete(uint16_t size) override {
+        }
+    };
+}
+
+#endif //MODBUSCAPTUREDEVICE_HPP
@@ -0,0 +1,178 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSCONVERT_HPP
+#define MODBUSCONVERT_HPP
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "ModbusUtils.hpp"
+
+/**
+ * Bulk conversions use SSE2 (x86-64) or NEON shuffles when available, 8 registers at a time.
+ * Build with EMODBUS_SIMD=0 to force the portable loop.
+ */
+#ifndef EMODBUS_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || defined(__ARM_NEON)
+#define EMODBUS_SIMD 1
+#else
+#define EMODBUS_SIMD 0
+#endif
+#endif
+
+#if EMODBUS_SIMD
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace eModbus {
+    /**
+     * @brief Order of the bytes of a multi-register value on the wire, A being the most significant byte.
+     * ABCD - big endian, most significant register first (Modbus default, what registersToU32 does);
+     * CDAB - registers swapped; BADC - bytes swapped inside each register; DCBA - little endian.
+     * For 64-bit values the same applies to all four registers (CDAB: last register first).
+     */
+    enum class WordOrder : uint8_t {
+        ABCD,
+        CDAB,
+        BADC,
+        DCBA,
+    };
+
+    namespace detail {
+        template<typename T>
+        concept BulkConvertible = std::is_arithmetic_v<T> && (sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+        template<size_t Size>
+        using UnsignedOfSize = std::conditional_t<Size == 2, uint16_t, std::conditional_t<Size == 4, uint32_t, uint64_t>>;
+
+        constexpr bool swapsRegisters(const WordOrder order) {
+            return order == WordOrder::CDAB || order == WordOrder::DCBA;
+        }
+
+        constexpr bool swapsBytes(const WordOrder order) {
+            return order == WordOrder::BADC || order == WordOrder::DCBA;
+        }
+
+        constexpr uint16_t swapBytes(const uint16_t value) {
+            return static_cast<uint16_t>(value << 8 | value >> 8);
+        }
+
+        template<typename T, WordOrder Order>
+        constexpr T fromWords(const uint16_t *registers) {
+            constexpr size_t Words = sizeof(T) / 2;
+            UnsignedOfSize<sizeof(T)> value = 0;
+            for (size_t k = 0; k < Words; ++k) {
+                const uint16_t word = registers[swapsRegisters(Order) ? Words - 1 - k : k];
+                value = static_cast<UnsignedOfSize<sizeof(T)>>(value << 8 << 8 | (swapsBytes(Order) ? swapBytes(word) : word));
+            }
+            return std::bit_cast<T>(value);
+        }
+
+        template<typename T, WordOrder Order>
+        constexpr void toWords(const T source, uint16_t *registers) {
+            constexpr size_t Words = sizeof(T) / 2;
+            auto value = std::bit_cast<UnsignedOfSize<sizeof(T)>>(source);
+            for (size_t k = Words; k-- > 0;) {
+                const auto word = static_cast<uint16_t>(value);
+                registers[swapsRegisters(Order) ? Words - 1 - k : k] = swapsBytes(Order) ? swapBytes(word) : word;
+                value = static_cast<UnsignedOfSize<sizeof(T)>>(value >> 8 >> 8);
+            }
+        }
+
+#if EMODBUS_SIMD
+        /**
+         * @brief Turns registers into native values (or back, it is its own inverse) 16 bytes at a time:
+         * reverses the register order inside each value and/or swaps the bytes of every register.
+         * @return number of values done, the caller finishes the rest.
+         */
+        template<size_t Words, bool ReverseRegisters, bool SwapBytes>
+        inline size_t permuteBlocks(const void *source, void *destination, const size_t values) {
+            constexpr size_t ValuesPerBlock = 8 / Words;
+            const size_t blocks = values / ValuesPerBlock;
+            const auto *in = static_cast<const uint8_t *>(source);
+            auto *out = static_cast<uint8_t *>(destination);
+            for (size_t block = 0; block < blocks; ++block, in += 16, out += 16) {
+#if defined(__SSE2__) || defined(_M_X64)
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+                if constexpr (ReverseRegisters && Words == 2) {
+                    x = _mm_shufflelo_epi16(x, 0xB1);
+                    x = _mm_shufflehi_epi16(x, 0xB1);
+                } else if constexpr (ReverseRegisters && Words == 4) {
+                    x = _mm_shufflelo_epi16(x, 0x1B);
+                    x = _mm_shufflehi_epi16(x, 0x1B);
+                }
+                if constexpr (SwapBytes)
+                    x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), x);
+#else
+                uint16x8_t x = vreinterpretq_u16_u8(vld1q_u8(in));
+                if constexpr (ReverseRegisters && Words == 2)
+                    x = vrev32q_u16(x);
+                else if constexpr (ReverseRegisters && Words == 4)
+                    x = vrev64q_u16(x);
+                if constexpr (SwapBytes)
+                    x = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(x)));
+                vst1q_u8(out, vreinterpretq_u8_u16(x));
+#endif
+            }
+            return blocks * ValuesPerBlock;
+        }
+
+        /** native values hold the most significant register last on little endian hosts, first on big endian ones */
+        template<typename T, WordOrder Order>
+        inline size_t permuteBlocks(const void *source, void *destination, const size_t values) {
+            constexpr bool little = std::endian::native == std::endian::little;
+            return permuteBlocks<sizeof(T) / 2, swapsRegisters(Order) != little, swapsBytes(Order)>(
+                source, destination, values);
+        }
+#endif
+    }
+
+    /**
+     * @brief Decodes consecutive values from registers into values, sizeof(T) / 2 registers each.
+     * T is any 16, 32 or 64-bit integer, float or double. Converts as many as both spans hold.
+     * @return number of values decoded
+     */
+    template<detail::BulkConvertible T, WordOrder Order = WordOrder::ABCD>
+    constexpr size_t bulkFromRegisters(const std::span<const uint16_t> registers, const std::span<T> values) {
+        constexpr size_t Words = sizeof(T) / 2;
+        const size_t count = std::min(values.size(), registers.size() / Words);
+        size_t done = 0;
+#if EMODBUS_SIMD
+        if (!std::is_constant_evaluated())
+            done = detail::permuteBlocks<T, Order>(registers.data(), values.data(), count);
+#endif
+        for (; done < count; ++done)
+            values[done] = detail::fromWords<T, Order>(registers.data() + done * Words);
+        return count;
+    }
+
+    /**
+     * @brief Encodes values into consecutive registers, sizeof(T) / 2 registers each.
+     * @return number of values encoded
+     */
+    template<detail::BulkConvertible T, WordOrder Order = WordOrder::ABCD>
+    constexpr size_t bulkToRegisters(const std::span<const T> values, const std::span<uint16_t> registers) {
+        constexpr size_t Words = sizeof(T) / 2;
+        const size_t count = std::min(values.size(), registers.size() / Words);
+        size_t done = 0;
+#if EMODBUS_SIMD
+        if (!std::is_constant_evaluated())
+            done = detail::permuteBlocks<T, Order>(values.data(), registers.data(), count);
+#endif
+        for (; done < count; ++done)
+            detail::toWords<T, Order>(values[done], registers.data() + done * Words);
+        return count;
+    }
+}
+
+#endif //MODBUSCONVERT_HPP
@@ -13,6 +13,13 @@
 #include <cstring>
 #include <ranges>
 #include <cassert>
+#include <array>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "ModbusByteRing.hpp"
+#include "ModbusTrace.hpp"
 
 namespace eModbus {
     inline char nibbleToHexChar(uint8_t nibble) {
@@ -103,7 +110,7 @@ namespace eModbus {
         };
 
 
-        static uint16_t calculateModbusCRC(const std::span<const uint8_t> data) {
+        static uint16_t calculateModbusCRC(const std::span<const uint8_t> data, uint16_t crc = 0xFFFF) {
             static constexpr uint16_t table[256] = {
                 0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
                 0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
@@ -140,7 +147,6 @@ namespace eModbus {
             };
 
             uint8_t xor_ = 0;
-            uint16_t crc = 0xFFFF;
             for (uint8_t byte: data) {
                 xor_ = byte ^ crc;
                 crc >>= 8;
@@ -149,6 +155,10 @@ namespace eModbus {
             return crc;
         }
 
+        static uint16_t calculateModbusCRC(const ByteRing::Segments &data) {
+            return calculateModbusCRC(data.second, calculateModbusCRC(data.first));
+        }
+
         uint16_t calculateModbusCRC() const {
             return calculateModbusCRC(_dataBuffer().subspan(RTU_HEADER_START_POSITION, RTULengthWithoutCRC()));
         }
@@ -197,7 +207,7 @@ namespace eModbus {
         // }
 
 
-        Frame &setRawRtuData(std::span<uint8_t> RTU_Data, bool is_request, bool copy = true) {
+        Frame &setRawRtuData(std::span<const uint8_t> RTU_Data, bool is_request, bool copy = true) {
             //			if(copy){
             isRequest(is_request);
             size_t copy_count = std::min(RTU_Data.size(), rtuBuffer().size());
@@ -239,7 +249,7 @@ namespace eModbus {
             return result;
         }
 
-        static Frame fromRawRtuData(std::span<uint8_t> RTU_Data, bool isRequest, uint16_t transaction_ID = 0,
+        static Frame fromRawRtuData(std::span<const uint8_t> RTU_Data, bool isRequest, uint16_t transaction_ID = 0,
                                           bool copy = true) {
             Frame result;
             result.setRawRtuData(RTU_Data, isRequest, copy);
@@ -467,13 +477,13 @@ namespace eModbus {
         };
 
         ValidationStatus validateTCP() const {
+            ValidationStatus result = validateCommon();
             if (protocolID() != 0)
-                return ValidationStatus::ProtocolIdentifier;
-
-            if (MBAPLength() == 0)
-                return ValidationStatus::MBAPHeaderLengthInvalid;
-
-            return validateCommon();
+                result = ValidationStatus::ProtocolIdentifier;
+            else if (MBAPLength() == 0)
+                result = ValidationStatus::MBAPHeaderLengthInvalid;
+            EMODBUS_TRACE_INSTANT(FrameValidated, slaveID(), functionCode(), MBAPLength(), result);
+            return result;
         }
 
         ValidationStatus validateCommon() const {
@@ -484,14 +494,35 @@ namespace eModbus {
         }
 
         ValidationStatus validateRTU() const {
-            ValidationStatus commonValidation = validateCommon();
-            if (commonValidation != ValidationStatus::OK)
-                return commonValidation;
-            if (crc() != calculateModbusCRC()) {
-                return ValidationStatus::InvalidCRC;
-            }
+            ValidationStatus result = validateCommon();
+            if (result == ValidationStatus::OK && crc() != calculateModbusCRC())
+                result = ValidationStatus::InvalidCRC;
+            EMODBUS_TRACE_INSTANT(FrameValidated, slaveID(), functionCode(), calculateRTULength(), result);
+            return result;
+        }
 
-            return ValidationStatus::OK;
+        /**
+         * @brief Validates an RTU ADU (CRC included) in place, e.g. straight in the receive ring, wrapped or not.
+         */
+        static ValidationStatus validateRTU(const ByteRing::Segments &adu) {
+            if (adu.size() < RTU_HEADER_SIZE + CRC_SIZE)
+                return ValidationStatus::Unknown;
+            if ((adu[1] & 0x7F) == 0)
+                return ValidationStatus::InvalidFunctionCode;
+            const size_t crc_pos = adu.size() - CRC_SIZE;
+            const uint16_t received_crc = adu[crc_pos] | (adu[crc_pos + 1] << 8);
+            const ValidationStatus result = received_crc == calculateModbusCRC(adu.subspan(0, crc_pos))
+                                                ? ValidationStatus::OK
+                                                : ValidationStatus::InvalidCRC;
+            EMODBUS_TRACE_INSTANT(FrameValidated, adu[0], adu[1], adu.size(), result);
+            return result;
+        }
+
+        Frame &setRawRtuData(const ByteRing::Segments &RTU_Data, bool is_request) {
+            isRequest(is_request);
+            RTU_Data.copyTo(rtuBuffer());
+            MBAPLength(RTULengthWithoutCRC());
+            return *this;
         }
 
         Frame &clear() {
@@ -567,33 +598,54 @@ namespace eModbus {
             }
         }
 
-        std::vector<uint16_t> registersValues()  {
-            const std::span<uint8_t> byte_span = registersData(); // Assuming this is valid for the call's duration
-            std::vector<uint16_t> result;
+        /**
+         * @brief Calls sink(value) for every decoded register value (coils as 0xFF00/0x0000) and returns the count.
+         * Allocation free, the overloads below only choose where the values go.
+         */
+        template<typename Sink>
+        size_t forEachRegisterValue(Sink &&sink) {
+            const std::span<uint8_t> byte_span = registersData();
             if (functionCode() == ReadCoils || functionCode() == ReadDiscreteInputs) {
-                result.reserve(byte_span.size() * 8); // Reserve for all bits
-                for (unsigned int i = 0; i < byte_span.size() * 8; ++i) {
-                    // Corrected iota range
-                    size_t bit_index = i % 8;
-                    size_t byte_index = i / 8;
-                    bool bit_value = (byte_span[byte_index] >> bit_index) & 0x1;
-                    result.push_back(static_cast<uint16_t>(bit_value ? 0xFF00 : 0));
+                for (size_t i = 0; i < byte_span.size() * 8; ++i) {
+                    const bool bit_value = (byte_span[i / 8] >> (i % 8)) & 0x1;
+                    sink(static_cast<uint16_t>(bit_value ? 0xFF00 : 0));
                 }
-            } else {
-                result.reserve(byte_span.size() / 2);
-                for (unsigned int i = 0; i < byte_span.size() / 2; ++i) {
-                    size_t idx1 = i * 2;
-                    size_t idx2 = i * 2 + 1;
+                return byte_span.size() * 8;
+            }
+            for (size_t i = 0; i < byte_span.size() / 2; ++i)
+                sink(static_cast<uint16_t>(byte_span[i * 2] << 8 | byte_span[i * 2 + 1]));
+            return byte_span.size() / 2;
+        }
 
-                    uint16_t val = static_cast<uint16_t>(byte_span[idx1]) |
-                                   (static_cast<uint16_t>(byte_span[idx2]) << 8); // Assuming little-endian in byte_span
+        size_t registersValuesCount() {
+            const size_t data_size = registersData().size();
+            return functionCode() == ReadCoils || functionCode() == ReadDiscreteInputs ? data_size * 8 : data_size / 2;
+        }
 
-                    result.push_back(swap_bytes(val));
-                }
-            }
+        std::vector<uint16_t> registersValues()  {
+            std::vector<uint16_t> result;
+            result.reserve(registersValuesCount());
+            forEachRegisterValue([&result](const uint16_t value) { result.push_back(value); });
             return result;
         }
 
+        std::pmr::vector<uint16_t> registersValues(std::pmr::memory_resource *resource) {
+            std::pmr::vector<uint16_t> result(resource);
+            result.reserve(registersValuesCount());
+            forEachRegisterValue([&result](const uint16_t value) { result.push_back(value); });
+            return result;
+        }
+
+        /** @brief Copies the values into the caller's buffer. @return number of values copied. */
+        size_t copyRegistersValues(const std::span<uint16_t> values) {
+            size_t count = 0;
+            forEachRegisterValue([&](const uint16_t value) {
+                if (count < values.size())
+                    values[count++] = value;
+            });
+            return count;
+        }
+
         Frame &registersValues(std::span<uint16_t> values) {
             if (hasRegistersValues()) {
                 std::span<uint8_t> registers_data = registersData();
@@ -685,7 +737,7 @@ namespace eModbus {
                 case ReadDiscreteInputs:
                 case ReadHoldingRegisters:
                 case ReadInputRegisters:
-                    if (_isRequest)
+                    if (isRequest)
                         return RTU_HEADER_SIZE + STARTING_ADDRESS_SIZE + REGISTER_COUNT_SIZE + CRC_SIZE;
                     else
                         return RTU_HEADER_SIZE + BYTE_COUNT_SIZE + byteCount + CRC_SIZE;
@@ -694,7 +746,7 @@ namespace eModbus {
                     return RTU_HEADER_SIZE + STARTING_ADDRESS_SIZE + WRITE_DATA_SIZE + CRC_SIZE;
                 case WriteMultipleCoils:
                 case WriteMultipleRegisters:
-                    if (_isRequest)
+                    if (isRequest)
                         return RTU_HEADER_SIZE + STARTING_ADDRESS_SIZE + REGISTER_COUNT_SIZE + BYTE_COUNT_SIZE + byteCount
                                + CRC_SIZE;
                     else
@@ -707,9 +759,68 @@ namespace eModbus {
         uint16_t calculateExpectedResponseRTULength() const {
             if (!_isRequest)
                 return RTULength();
-            return calculateRTULength(false,true,functionCode(),registerCount()*2);
+            const bool bits = functionCode() == ReadCoils || functionCode() == ReadDiscreteInputs;
+            return calculateRTULength(false,false,functionCode(),bits ? (registerCount() + 7) / 8 : registerCount()*2);
+        }
+
+        /** first bytes of an RTU response that tell its length: slave ID, function code, byte count or exception code */
+        static constexpr uint8_t RTU_RESPONSE_HEAD_SIZE = 3;
+
+        /**
+         * @brief Length of an RTU response (CRC included) from its first RTU_RESPONSE_HEAD_SIZE bytes,
+         * 0 for a function code whose length is not known. The function code high bit means a 5 byte exception.
+         */
+        static constexpr uint16_t responseRTULength(const std::span<const uint8_t> head) {
+            const uint8_t function_code = head[1];
+            if (function_code & 0x80)
+                return RTU_HEADER_SIZE + EXCEPTION_CODE_SIZE + CRC_SIZE;
+            switch (function_code) {
+                case ReadCoils:
+                case ReadDiscreteInputs:
+                case ReadHoldingRegisters:
+                case ReadInputRegisters:
+                    return RTU_HEADER_SIZE + BYTE_COUNT_SIZE + head[2] + CRC_SIZE;
+                case WriteSingleCoil:
+                case WriteSingleRegister:
+                    return RTU_HEADER_SIZE + STARTING_ADDRESS_SIZE + WRITE_DATA_SIZE + CRC_SIZE;
+                case WriteMultipleCoils:
+                case WriteMultipleRegisters:
+                    return RTU_HEADER_SIZE + STARTING_ADDRESS_SIZE + REGISTER_COUNT_SIZE + CRC_SIZE;
+                default:
+                    return 0;
+            }
         }
-        int calculateResponseTransmissionTimeMs(const int bitsPerSecond){
+
+        /** first bytes of an RTU request that tell its length, up to the byte count of the write multiple requests */
+        static constexpr uint8_t RTU_REQUEST_HEAD_SIZE = 7;
+
+        /**
+         * @brief Length of an RTU request (CRC included) from its first RTU_REQUEST_HEAD_SIZE bytes,
+         * 0 for a function code whose length is not known.
+         */
+        static constexpr uint16_t requestRTULength(const std::span<const uint8_t> head) {
+            switch (head[1]) {
+                case ReadCoils:
+                case ReadDiscreteInputs:
+                case ReadHoldingRegisters:
+                case ReadInputRegisters:
+                case WriteSingleCoil:
+                case WriteSingleRegister:
+                    return RTU_HEADER_SIZE + STARTING_ADDRESS_SIZE + REGISTER_COUNT_SIZE + CRC_SIZE;
+                case WriteMultipleCoils:
+                case WriteMultipleRegisters:
+                    return RTU_HEADER_SIZE + STARTING_ADDRESS_SIZE + REGISTER_COUNT_SIZE + BYTE_COUNT_SIZE + head[6]
+                           + CRC_SIZE;
+                default:
+                    return 0;
+            }
+        }
+
+        /** @brief Length of a TCP ADU from its MBAP header; the length field counts the unit ID and the PDU. */
+        static constexpr uint16_t tcpADULength(const std::span<const uint8_t> mbap_header) {
+            return MBAP_HEADER_SIZE - UNIT_ID_SIZE + (mbap_header[LENGTH] << 8 | mbap_header[LENGTH + 1]);
+        }
+        int calculateResponseTransmissionTimeMs(const int bitsPerSecond) const {
             // constexpr int SLAVE_ID_LEN = 1;
             // constexpr int FUNCTION_LEN = 1;
             // constexpr int BYTE_COUNT_LEN = 1;
@@ -719,7 +830,7 @@ namespace eModbus {
             int length = calculateExpectedResponseRTULength();
             return calculateTransmissionTimeMs(length,bitsPerSecond);
         }
-        int calculateTransmissionTimeMs(const size_t length, const int bitsPerSecond) {
+        static int calculateTransmissionTimeMs(const size_t length, const int bitsPerSecond) {
             constexpr int BITS_PER_BYTE = 10;
             constexpr int INCREASE_PRECISION = 10;
             const int result = ((BITS_PER_BYTE * 1000 * static_cast<ssize_t>(length) * INCREASE_PRECISION / bitsPerSecond) +
@@ -728,9 +839,47 @@ namespace eModbus {
             // return (result < 3)?3:result;
             return (result < 0)?0:result;
         }
-        int calculateTransmissionTimeMs(const int bitsPerSecond) {
+        int calculateTransmissionTimeMs(const int bitsPerSecond) const {
             return calculateTransmissionTimeMs(calculateRTULength(),bitsPerSecond);
         }
+
+        /** start + 8 data + parity + stop, or start + 8 data + 2 stop without parity */
+        static constexpr uint32_t BITS_PER_CHARACTER = 11;
+        /** above this baud rate the spec fixes t1.5 and t3.5 instead of scaling them with the character time */
+        static constexpr uint32_t FIXED_TIMING_ABOVE_BAUD = 19200;
+        static constexpr uint32_t FIXED_T15_US = 750;
+        static constexpr uint32_t FIXED_T35_US = 1750;
+
+        static constexpr uint32_t characterTime_us(const uint32_t baud) {
+            return baud ? (BITS_PER_CHARACTER * 1000000 + baud - 1) / baud : 0;
+        }
+
+        /** @brief Time length bytes take on the line, rounded up to a microsecond. */
+        static constexpr uint32_t transmissionTime_us(const size_t length, const uint32_t baud) {
+            return baud ? static_cast<uint32_t>((BITS_PER_CHARACTER * 1000000ull * length + baud - 1) / baud) : 0;
+        }
+
+        /** @brief Longest silence allowed inside a frame. */
+        static constexpr uint32_t t15_us(const uint32_t baud) {
+            if (baud == 0 || baud > FIXED_TIMING_ABOVE_BAUD)
+                return FIXED_T15_US;
+            return (BITS_PER_CHARACTER * 1000000 * 3 + 2 * baud - 1) / (2 * baud);
+        }
+
+        /** @brief Shortest silence between two frames. */
+        static constexpr uint32_t t35_us(const uint32_t baud) {
+            if (baud == 0 || baud > FIXED_TIMING_ABOVE_BAUD)
+                return FIXED_T35_US;
+            return (BITS_PER_CHARACTER * 1000000 * 7 + 2 * baud - 1) / (2 * baud);
+        }
+
+        uint32_t transmissionTime_us(const uint32_t baud) const {
+            return transmissionTime_us(calculateRTULength(), baud);
+        }
+
+        uint32_t responseTransmissionTime_us(const uint32_t baud) const {
+            return transmissionTime_us(calculateExpectedResponseRTULength(), baud);
+        }
         //TODO assign registersValues split into request and response
 
         static Frame build(bool is_request, uint8_t slave_ID, FunctionCode function_code, uint16_t start_address,
@@ -747,6 +896,7 @@ namespace eModbus {
                              uint16_t transaction_ID = 0) {
             isRequest(is_request);
             transactionID(transaction_ID);
+            protocolID(0);
             slaveID(slave_ID);
             functionCode(function_code);
 
@@ -757,6 +907,7 @@ namespace eModbus {
 
             MBAPLength(RTULengthWithoutCRC());
             appendCRC();
+            EMODBUS_TRACE_INSTANT(FrameBuilt, slave_ID, function_code, calculateRTULength());
             return *this;
         }
 
@@ -769,7 +920,9 @@ namespace eModbus {
 
         Frame &rebuildExceptionResponse(uint8_t slave_ID, FunctionCode function_code, ExceptionCode exception_code,
                                               uint16_t transaction_ID = 0) {
+            isRequest(false);
             transactionID(transaction_ID);
+            protocolID(0);
             slaveID(slave_ID);
             functionCode(function_code);
             isException(true);
@@ -777,6 +930,7 @@ namespace eModbus {
 
             MBAPLength(RTULengthWithoutCRC());
             appendCRC();
+            EMODBUS_TRACE_INSTANT(FrameBuilt, slave_ID, function_code, calculateRTULength());
             return *this;
         }
 
@@ -800,7 +954,7 @@ namespace eModbus {
 
     };
 
-    static std::string to_string(const Frame::ValidationStatus status) {
+    constexpr const char *to_c_string(const Frame::ValidationStatus status) {
         switch (status) {
             case Frame::ValidationStatus::OK:return "OK";
             case Frame::ValidationStatus::InvalidCRC:return "Invalid CRC";
@@ -811,5 +965,9 @@ namespace eModbus {
         }
 
     }
+
+    inline std::string to_string(const Frame::ValidationStatus status) {
+        return to_c_string(status);
+    }
 }
 #endif /* INC_MODBUS_HPP_ */
@@ -0,0 +1,123 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSFRAMEPOOL_HPP
+#define MODBUSFRAMEPOOL_HPP
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+
+#include "ModbusFrame.hpp"
+
+namespace eModbus {
+    /**
+     * @brief Fixed set of N frames handed out as RAII handles, for gateways and masters that keep many frames in
+     * flight. Frames are constructed (and zero filled) once with the pool, a handle gives back the frame as it was
+     * left by its previous user: fill it in place with rebuild(), rebuildExceptionResponse(), setRawRtuData()
+     * or setRawTcpData(). Each frame sits in its own cache lines, released frames are reused first (LIFO),
+     * so a steady request/response loop keeps touching the same memory.
+     *
+     * Not thread safe: one pool per event loop / master thread.
+     */
+    template<size_t N>
+    class FramePool {
+        static_assert(N > 0 && N <= UINT16_MAX, "FramePool capacity must fit uint16_t");
+
+    public:
+        class Handle {
+        public:
+            Handle() = default;
+
+            Handle(Handle &&other) noexcept
+                : pool_{std::exchange(other.pool_, nullptr)}, index_{other.index_} {
+            }
+
+            Handle &operator=(Handle &&other) noexcept {
+                if (this != &other) {
+                    reset();
+                    pool_ = std::exchange(other.pool_, nullptr);
+                    index_ = other.index_;
+                }
+                return *this;
+            }
+
+            Handle(const Handle &) = delete;
+            Handle &operator=(const Handle &) = delete;
+
+            ~Handle() {
+                reset();
+            }
+
+            /** @brief Gives the frame back to the pool, the handle becomes empty. */
+            void reset() {
+                if (pool_)
+                    std::exchange(pool_, nullptr)->release(index_);
+            }
+
+            explicit operator bool() const {
+                return pool_ != nullptr;
+            }
+
+            Frame &operator*() const {
+                return pool_->slots_[index_].frame;
+            }
+
+            Frame *operator->() const {
+                return &pool_->slots_[index_].frame;
+            }
+
+            Frame *get() const {
+                return pool_ ? &pool_->slots_[index_].frame : nullptr;
+            }
+
+        private:
+            friend class FramePool;
+
+            Handle(FramePool *pool, const uint16_t index) : pool_{pool}, index_{index} {
+            }
+
+            FramePool *pool_ = nullptr;
+            uint16_t index_ = 0;
+        };
+
+        FramePool() {
+            std::iota(freeList_.rbegin(), freeList_.rend(), uint16_t{0});
+        }
+
+        FramePool(const FramePool &) = delete;
+        FramePool &operator=(const FramePool &) = delete;
+
+        /** @brief A free frame, or an empty handle when all N are in use. */
+        Handle acquire() {
+            if (freeCount_ == 0)
+                return {};
+            return Handle(this, freeList_[--freeCount_]);
+        }
+
+        size_t available() const {
+            return freeCount_;
+        }
+
+        static constexpr size_t capacity() {
+            return N;
+        }
+
+    private:
+        struct alignas(64) Slot {
+            Frame frame;
+        };
+
+        std::array<Slot, N> slots_;
+        std::array<uint16_t, N> freeList_{};
+        size_t freeCount_ = N;
+
+        void release(const uint16_t index) {
+            freeList_[freeCount_++] = index;
+        }
+    };
+}
+
+#endif //MODBUSFRAMEPOOL_HPP
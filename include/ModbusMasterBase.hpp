@@ -10,49 +10,126 @@
 
 
 #include <IStreamDevice.hpp>
+#include <array>
+#include <chrono>
+#include <cstdio>
 #include <map>
+#include <memory_resource>
+#include <random>
+#include <stdexcept>
 
 #include "ModbusFrame.hpp"
 #include <mutex>
 
+#include "ModbusMetrics.hpp"
+
 #include "ModbusRegisterBuffer.hpp"
+#include "ModbusRetryPolicy.hpp"
 #include "ModbusUtils.hpp"
 
 namespace eModbus {
 	class MasterBase{
+	public:
+		using BaudrateMap = std::pmr::map<uint8_t, uint32_t>;
+		/**
+		 * How ADUs travel on the stream device:
+		 * RTU - serial line, CRC, t3.5 gaps and baud rate detection;
+		 * TCP - Modbus TCP, MBAP header and no CRC;
+		 * RTUoverTCP - RTU ADUs, CRC included, through a TCP socket (transparent serial servers), no MBAP header.
+		 */
+		enum class Transport : uint8_t {
+			RTU,
+			TCP,
+			RTUoverTCP,
+		};
 	protected:
-		explicit MasterBase(IStreamDevice& serial_device);
+		/** resource backs the internal containers; in steady state (all slaves detected) the master does not allocate */
+		explicit MasterBase(IStreamDevice& serial_device,
+		                    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 		IStreamDevice& _streamDevice;
-		bool isTCP = false;
-		std::map<uint8_t,uint32_t> devicesBaudratesMap;
+		Transport transport = Transport::RTU;
+		BaudrateMap devicesBaudratesMap;
+		/** frames of the current transaction, rebuilt in place for every request instead of built on the stack */
+		Frame _request;
+		Frame _response;
+		/** end of the last response (or timeout), the next request waits until t3.5 after it */
+		std::chrono::steady_clock::time_point _lineIdleSince{};
+		/** jitter of the retry backoff */
+		std::minstd_rand _retryRandom{};
+#if EMODBUS_METRICS
+		Metrics* _metrics = nullptr;
+#endif
+		/** @brief sendReceiveFrame for a request encoded beforehand with encodeRequest(), e.g. by a cached plan. */
+		void sendReceiveEncoded(const eModbus::Frame &send_frame, std::span<const uint8_t> request,
+		                        eModbus::Frame &receive_frame);
+
+		/** @brief ADU of frame for this master's transport; CRC or MBAP length are filled in in place. */
+		std::span<const uint8_t> encodeRequest(eModbus::Frame &frame) const {
+			return encode(frame);
+		}
+
+		Metrics* metricsSink() const {
+#if EMODBUS_METRICS
+			return _metrics;
+#else
+			return nullptr;
+#endif
+		}
 
 	public:
 		static constexpr std::array<uint32_t, 10> baudrates{
 			9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1000000, 2000000
 		};
-		uint32_t deviceResponseTime_ms = 30;
-		const std::map<uint8_t, uint32_t>& devices_baudrates_map() const {
+		/** longest time a slave may take between the end of the request and the start of its response */
+		uint32_t deviceResponseTime_us = 30000;
+		/** retries of failed transactions, none by default */
+		RetryPolicy retryPolicy;
+		Transport transportMode() const {
+			return transport;
+		}
+		const BaudrateMap& devices_baudrates_map() const {
 			return devicesBaudratesMap;
 		}
+#if EMODBUS_METRICS
+		/** Transactions of this master are recorded into metrics (nullptr disables it). Metrics may be shared. */
+		void metrics(Metrics* metrics) {
+			_metrics = metrics;
+		}
+		Metrics* metrics() const {
+			return _metrics;
+		}
+#endif
 
 
 		class Exception :public std::runtime_error {
 		public:
 			explicit Exception(const std::string &message)
 			:std::runtime_error(message){};
+			explicit Exception(const char* message)
+			:std::runtime_error(message){};
+		protected:
+			/** Text of the library's own exceptions, built on the stack instead of from std::string pieces.
+			 * format is always one of the fixed messages below, never a caller's string. */
+			template<typename... Args>
+			static std::array<char, 64> formatted(const char* format, Args... args) {
+				std::array<char, 64> message{};
+				std::snprintf(message.data(), message.size(), format, args...);
+				return message;
+			}
 		};
 		class ModbusException:public Exception{
 		public:
 			eModbus::Frame::ExceptionCode _exception_code;
 			explicit ModbusException(const eModbus::Frame::ExceptionCode exception_code)
-			:Exception("Modbus Exception Code "+ std::to_string(exception_code)),_exception_code(exception_code)
+			:Exception(formatted("Modbus Exception Code %d", static_cast<int>(exception_code)).data()),
+			_exception_code(exception_code)
 			{};
 		};
 		class InvalidFrame:public Exception{
 		public:
 			eModbus::Frame::ValidationStatus _validation_status;
 			explicit InvalidFrame(const eModbus::Frame::ValidationStatus validation_status)
-			:Exception("Validation Failed Code "+to_string(validation_status)),
+			:Exception(formatted("Validation Failed Code %s", to_c_string(validation_status)).data()),
 			_validation_status(validation_status)
 			{};
 		};
@@ -60,20 +137,31 @@ namespace eModbus {
 		public:
 			SerialError _device_error;
 			explicit StreamDeviceFailure(const SerialError device_error)
-			:Exception("Stream Failure Code:" + to_string(device_error)),
+			:Exception(formatted("Stream Failure Code:%s", to_c_string(device_error)).data()),
 			_device_error(device_error)
 			{};
 		};
 		class ResponseTimeout:public Exception{
 
 		};
-		static eModbus::MasterBase TCP(IStreamDevice& serial_device);
+		static eModbus::MasterBase TCP(IStreamDevice& serial_device,
+		                               std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		static eModbus::MasterBase RTU(IStreamDevice& serial_device,
+		                               std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
-		static eModbus::MasterBase RTU(IStreamDevice& serial_device);
+		/** @brief RTU frames over a stream socket; baud rate is not detected, timing uses device.baudrate() if known. */
+		static eModbus::MasterBase RTUoverTCP(IStreamDevice& serial_device,
+		                                      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
 
 		std::vector<uint16_t> read(uint8_t slave_ID, RegisterType register_type,uint16_t start_address,uint8_t quantity);
 
+		/** @brief Same as above, the result is allocated from resource (e.g. a per-cycle monotonic buffer). */
+		std::pmr::vector<uint16_t> read(uint8_t slave_ID, RegisterType register_type, uint16_t start_address,
+		                                uint8_t quantity, std::pmr::memory_resource* resource);
+
+		/** @brief Reads straight into the caller's buffer, does not allocate. */
 		void read(uint8_t slave_ID, const eModbus::RegisterBufferView &outBuffer);
 
 		void write(uint8_t slave_ID, RegisterType register_type,uint16_t start_address,std::span<uint16_t> values);
@@ -84,14 +172,64 @@ namespace eModbus {
 
 		void sendReceiveFrame(eModbus::Frame &send_frame, eModbus::Frame &receive_frame);
 
-		uint32_t getResponseTimeout(eModbus::Frame send_frame, unsigned long baud) const;
+		/** @brief Write timeout in ms: wire time of the request plus t3.5, computed in microseconds. */
+		uint32_t getSendTimeout(const eModbus::Frame &send_frame, uint32_t baud) const;
+
+		/** @brief Read timeout in ms: wire time of the expected response, t3.5 and deviceResponseTime_us. */
+		uint32_t getResponseTimeout(const eModbus::Frame &send_frame, unsigned long baud) const;
 
 		uint32_t detectBaud(uint8_t slave_ID, std::span<const uint32_t> baudrates);
 
-		std::map<uint8_t, uint32_t> scanForDevices(std::span<uint32_t> baudrates, uint16_t timeoutMs = 10);
+		BaudrateMap scanForDevices(std::span<uint32_t> baudrates, uint16_t timeoutMs = 10);
 
 		static Frame::FunctionCode getFunctionCode(bool isRead,RegisterType register_type);
 
+	private:
+		/** TCP carries the MBAP header instead of a CRC */
+		bool usesMBAP() const {
+			return transport == Transport::TCP;
+		}
+
+		/** only a real serial line has a baud rate to detect and t3.5 gaps to keep */
+		bool isSerialLine() const {
+			return transport == Transport::RTU;
+		}
+
+		std::span<const uint8_t> encode(eModbus::Frame &frame) const {
+			return usesMBAP() ? frame.tcpFrame() : frame.rtuFrame();
+		}
+
+		eModbus::Frame::ValidationStatus validateResponse(const eModbus::Frame &receive_frame) const {
+			return usesMBAP() ? receive_frame.validateTCP() : receive_frame.validateRTU();
+		}
+
+		/** @brief RTU: lets the device hold the line silent until t3.5 after the last response. */
+		void waitInterFrameDelay(uint32_t baud) const;
+
+		void markLineIdle();
+
+		void writeRequest(const eModbus::Frame &send_frame, std::span<const uint8_t> data, uint32_t timeout_ms) const;
+
+		/** @brief One try of sendReceiveFrame with the already encoded request. */
+		void sendReceiveAttempt(const eModbus::Frame &send_frame, std::span<const uint8_t> request,
+		                        eModbus::Frame &receive_frame, uint32_t baud);
+
+		/**
+		 * @brief Reads one response ADU in two steps: the bytes that tell its length (RTU and RTU over TCP: slave ID,
+		 * function code and byte count or exception code; TCP: MBAP header), then exactly the rest. This also
+		 * deframes RTU over TCP, where no idle line marks the end of a frame and a socket may split it anywhere. An exception response is
+		 * complete after 5 bytes instead of waiting for the length of a normal response.
+		 * The bytes go through the device's blocking read() into the frame, also when the device has an rxRing:
+		 * the ring has no way to wait for data with a timeout, so only the listen-only BusSniffer, which processes
+		 * whatever has arrived, parses frames in place in the ring.
+		 */
+		SerialError readResponse(eModbus::Frame &receive_frame, uint32_t timeout_ms,
+		                         size_t* bytes_read_out = nullptr) const;
+
+		/** @brief Rebuilds _request, runs it and returns the (non exception) response. */
+		Frame &transact(uint8_t slave_ID, bool is_read, RegisterType register_type, uint16_t start_address,
+		                uint16_t quantity, std::span<uint16_t> values = {});
+
 	};
 }
 
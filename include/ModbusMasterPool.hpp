@@ -0,0 +1,140 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSMASTERPOOL_HPP
+#define MODBUSMASTERPOOL_HPP
+
+#include <array>
+#include <chrono>
+#include <compare>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "IStreamDevice.hpp"
+#include "ModbusFrame.hpp"
+#include "ModbusUtils.hpp"
+
+namespace eModbus {
+    /**
+     * @brief Modbus TCP master that owns many gateway connections and multiplexes them on one epoll loop.
+     *
+     * Requests are routed by (connection, unit ID), where the unit ID is taken from the request frame.
+     * Every connection keeps a pipelining window: up to `window` transactions are in flight at once
+     * and are matched back by their MBAP transaction ID, the rest wait in the connection queue.
+     * All frames that fit the window leave in a single gathered sendmsg() straight from their Frame buffers.
+     *
+     * The pool is single threaded - submit() and poll() have to be called from the thread that owns it.
+     * To use all cores, create one pool per core and shard the endpoints between them.
+     * Linux only (epoll).
+     */
+    class MasterPool {
+    public:
+        struct Endpoint {
+            std::string host;
+            uint16_t port = 502;
+
+            auto operator<=>(const Endpoint &) const = default;
+        };
+
+        using ConnectionID = uint32_t;
+        /** Called exactly once per submitted request. On SerialError::SUCCESS response holds a validated TCP frame,
+         * which can still be a modbus exception response. On error the request frame is passed back. */
+        using Callback = std::function<void(SerialError error, Frame &response)>;
+
+        static constexpr size_t DefaultWindow = 4;
+        uint32_t reconnectDelay_ms = 1000;
+        /** a connect still pending after this is dropped and the queued requests fail with TIMEOUT */
+        uint32_t connectTimeout_ms = 3000;
+
+        MasterPool();
+        ~MasterPool();
+        MasterPool(const MasterPool &) = delete;
+        MasterPool &operator=(const MasterPool &) = delete;
+
+        /**
+         * @brief Registers a gateway. Returns the existing connection if the endpoint is already known.
+         * The socket is connected lazily, on the first poll() with pending requests.
+         */
+        ConnectionID addEndpoint(const Endpoint &endpoint, size_t window = DefaultWindow);
+
+        ConnectionID connection(const Endpoint &endpoint) const;
+
+        /**
+         * @brief Queues a request. The unit ID is taken from request.slaveID(), transaction ID is assigned by the pool.
+         * timeout_ms counts from submit(), so it covers waiting for the connection and the window as well.
+         */
+        void submit(ConnectionID connection_id, const Frame &request, Callback callback, uint32_t timeout_ms);
+
+        void read(ConnectionID connection_id, uint8_t unit_ID, RegisterType register_type, uint16_t start_address,
+                  uint16_t quantity, Callback callback, uint32_t timeout_ms);
+
+        /**
+         * @brief Runs one iteration of the event loop: waits for socket events at most timeout_ms,
+         * sends queued requests, dispatches responses and expires timed out transactions.
+         * @return number of callbacks invoked
+         */
+        size_t poll(uint32_t timeout_ms);
+
+        /** @brief Polls until there are no queued or in-flight requests left. */
+        void runUntilIdle(uint32_t poll_timeout_ms = 100);
+
+        size_t pending() const;
+
+        size_t connectionsCount() const {
+            return _connections.size();
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Transaction {
+            Frame frame;
+            Callback callback;
+            uint32_t timeout_ms;
+            Clock::time_point deadline;
+            uint16_t unsent = 0; // bytes of the ADU still waiting for the socket
+        };
+
+        enum class State : uint8_t {
+            Disconnected,
+            Connecting,
+            Connected,
+        };
+
+        struct Connection {
+            Endpoint endpoint;
+            size_t window;
+            int fd = -1;
+            State state = State::Disconnected;
+            uint16_t nextTransactionID = 1;
+            Clock::time_point reconnectAt{};
+            Clock::time_point connectDeadline{};
+            std::deque<Transaction> queued;
+            std::vector<Transaction> inFlight;
+            std::array<uint8_t, 1024> rxBuffer{};
+            size_t rxSize = 0;
+            bool wantWrite = false;
+        };
+
+        int _epollFd = -1;
+        std::deque<Connection> _connections; // deque keeps references valid when callbacks add endpoints
+        std::map<Endpoint, ConnectionID> _endpoints;
+
+        bool connect(ConnectionID connection_id, Clock::time_point now);
+        void disconnect(ConnectionID connection_id, SerialError reason, size_t &dispatched);
+        void updateInterest(ConnectionID connection_id, bool want_write);
+        void fillWindow(Connection &connection);
+        bool flushTx(ConnectionID connection_id);
+        bool receive(ConnectionID connection_id, size_t &dispatched);
+        void dispatchFrames(Connection &connection, size_t &dispatched);
+        bool expire(Connection &connection, Clock::time_point now, size_t &dispatched);
+        Clock::time_point nearestDeadline(Clock::time_point fallback) const;
+    };
+}
+
+#endif //MODBUSMASTERPOOL_HPP
@@ -5,13 +5,19 @@
 #ifndef MODBUSMASTERTAG_HPP
 #define MODBUSMASTERTAG_HPP
 #include <algorithm>
+#include <memory_resource>
 #include <mutex>
-#include <qlist.h>
+#include <ranges>
 #include <set>
+#include <unordered_map>
 #include <variant>
 #include "ModbusMasterBase.hpp"
+#include "ModbusPollScheduler.hpp"
+#include "ModbusReadPlan.hpp"
+#include "ModbusReadPlanner.hpp"
 #include "ModbusRegisterBuffer.hpp"
 #include "ModbusTag.hpp"
+#include "ModbusTagDatabase.hpp"
 /** Use Cases
  * 1. Aktualizacja read wartości - może byc asynchronicznie. Gdy przyjda nowe wartosci to tylko aktualizacja w modelu
  * 2. Synchroniczna sekwencja - np. write, read, write np. przeprowadzenie backupu
@@ -38,15 +44,25 @@ namespace eModbus {
     public:
         using MasterBase::MasterBase;
         using TagID = std::string;
-        using TagMap = std::unordered_map<TagID, size_t>;
+        using TagHandle = TagDatabase::Handle;
         using TagValue = std::string;
         using TagValueMap = std::map<TagID, TagValue>;
 
-        struct Request {
-            RegisterType registerType;
-            uint16_t startAddress;
-            uint16_t quantity;
-        };
+        using Request = ReadRequest;
+
+        /**
+         * Splits tags into requests. Its cost model gives the turnaround and frame overheads; the bus itself
+         * (baud rate, or free bytes over TCP) comes from this master, see costModel().
+         */
+        ReadPlanner readPlanner;
+        /** false plans with readPlanner.costModel exactly as set */
+        bool costModelFromBus = true;
+
+        /** Most plans readPlan() keeps; every mix of tags read together is one, 0 is no limit. */
+        size_t planCacheCapacity = 64;
+
+        /** Tag groups and their periods for runPolling(). */
+        PollScheduler polling;
 
         void registerTags(const std::vector<Tag> &tagsToRegister) {
             // OK, wiec tagi w bazie danych musza byc koniecznie posortowane wedlug typu rejestru i numeru
@@ -54,38 +70,173 @@ namespace eModbus {
             // for (const auto &[id, tag] : tagsToRegister) {
             //     tagsDatabase.insert_or_assign(id, tag);
             // }
+            // TagDatabase keeps them sorted by register type and number, handles follow that order
             clearTags();
-            tagsDatabase = tagsToRegister;
-            std::ranges::sort(tagsDatabase, [](const Tag &a, const Tag &b) {
-                return (a.register_type < b.register_type) ||
-                       (a.register_type == b.register_type && a.register_number < b.register_number);
-            });
-
-            for (size_t i = 0; i < tagsDatabase.size(); ++i) {
-                // Use the element's key and its new index 'i'
-                IDtoTagMap.emplace(TagID{tagsDatabase[i].key}, i);
-            }
+            tagsDatabase.assign(tagsToRegister);
+            excludedTags.assign(tagsDatabase.size(), false);
         }
 
         void clearTags() {
-            IDtoTagMap.clear();
+            invalidatePlans();
             tagsDatabase.clear();
+            excludedTags.clear();
+        }
+
+        const TagDatabase &tags() const {
+            return tagsDatabase;
+        }
+
+        /** @brief Planned reads skip the tag. */
+        void excludeTag(const TagHandle tag, const bool excluded = true) {
+            if (tagsDatabase.contains(tag) && excludedTags[tag] != excluded) {
+                excludedTags[tag] = excluded;
+                invalidatePlans();
+            }
+        }
+
+        /** @brief Planned reads never cover these registers (e.g. holes the slave answers with an exception). */
+        void excludeRegisters(const RegisterType registerType, const uint16_t firstRegisterNumber, const uint16_t count) {
+            for (uint32_t number = firstRegisterNumber; number < firstRegisterNumber + count && number <= 0xFFFF; ++number)
+                excludedRegisters[static_cast<size_t>(registerType)].insert(static_cast<uint16_t>(number));
+            invalidatePlans();
+        }
+
+        void clearExcludedRegisters() {
+            for (auto &registers: excludedRegisters)
+                registers.clear();
+            invalidatePlans();
+        }
+
+        /**
+         * @brief Compiled plan for reading tags from a slave, built on first use and cached by the tag set.
+         * The reference stays valid until the plans are invalidated: registerTags(), clearTags(), a change of the
+         * excluded tags or registers, or invalidatePlans() (call it after changing readPlanner). A call that has
+         * to compile a plan while planCacheCapacity plans are cached drops the least recently used one, so hold
+         * on to the reference only while using it.
+         */
+        const ReadPlan &readPlan(const uint8_t slave_ID, const std::span<const TagHandle> tags) {
+            const uint64_t fingerprint = fingerprintOf(slave_ID, tags);
+            const ReadCostModel model = costModel(slave_ID);
+            auto [first, last] = readPlans.equal_range(fingerprint);
+            for (; first != last; ++first) {
+                ReadPlan &cached = first->second;
+                if (cached.slaveID_ != slave_ID || !std::ranges::equal(cached.tags_, tags))
+                    continue;
+                // planned before the slave's baud rate was known, or before it changed
+                if (cached.costModel_ != model) {
+                    readPlans.erase(first);
+                    break;
+                }
+                cached.lastUse_ = ++planUses;
+                return cached;
+            }
+            if (planCacheCapacity != 0 && readPlans.size() >= planCacheCapacity)
+                readPlans.erase(std::ranges::min_element(readPlans, {}, [](const auto &cached) {
+                    return cached.second.lastUse_;
+                }));
+            ReadPlan &compiled = readPlans.emplace(fingerprint, compilePlan(slave_ID, tags, fingerprint, model))->second;
+            compiled.lastUse_ = ++planUses;
+            return compiled;
+        }
+
+        size_t cachedPlansCount() const {
+            return readPlans.size();
+        }
+
+        /**
+         * @brief Cost model reads from slave_ID are planned with: readPlanner.costModel on this master's bus.
+         * A TCP master moves bytes for free (baud rate 0); RTU and RTU over TCP run at the slave's detected baud
+         * rate, else at the device's, else at readPlanner.costModel's. Just readPlanner.costModel with
+         * costModelFromBus off.
+         */
+        ReadCostModel costModel(const uint8_t slave_ID) const {
+            ReadCostModel model = costModel();
+            if (!costModelFromBus || transportMode() == Transport::TCP)
+                return model;
+            if (const auto it = devicesBaudratesMap.find(slave_ID); it != devicesBaudratesMap.end() && it->second != 0)
+                model.baudrate = it->second;
+            return model;
+        }
+
+        /** @brief Same for the bus as a whole, when the slave is not known (prepareReadRequests()). */
+        ReadCostModel costModel() const {
+            ReadCostModel model = readPlanner.costModel;
+            if (!costModelFromBus)
+                return model;
+            if (transportMode() == Transport::TCP)
+                model.baudrate = 0;
+            else if (const uint32_t baudrate = _streamDevice.baudrate(); baudrate != IStreamDevice::InvalidBaudrate)
+                model.baudrate = baudrate;
+            return model;
+        }
+
+        /**
+         * @brief Runs a plan: sends its encoded frames and copies the responses into registers, which must hold
+         * plan.registerCount(). Nothing is planned, sorted or allocated.
+         */
+        void read(const ReadPlan &plan, const std::span<uint16_t> registers) {
+            for (size_t request = 0; request < plan.requests_.size(); ++request)
+                read(plan, request, registers);
         }
 
-        void runPolling();
+        /**
+         * @brief Runs one request of a plan, filling only its part of registers (plan.requestOffset(request)
+         * onwards). Lets a caller keep what the other requests read when one of them fails.
+         */
+        void read(const ReadPlan &plan, const size_t request, const std::span<uint16_t> registers) {
+            if (registers.size() < plan.registerCount())
+                throw std::out_of_range("Register buffer smaller than the read plan");
+            sendReceiveEncoded(plan.frames_[request], plan.encoded(request), _response);
+            if (_response.isException())
+                throw ModbusException(_response.exceptionCode());
+            _response.copyRegistersValues(registers.subspan(plan.requestOffsets_[request],
+                                                            plan.requests_[request].quantity));
+        }
+
+        void invalidatePlans() {
+            readPlans.clear();
+        }
+
+        /** @return handle of a registered tag, TagDatabase::InvalidHandle if it is not registered */
+        TagHandle handle(const std::string_view tagID) const {
+            return tagsDatabase.find(tagID);
+        }
+
+        /** @brief Resolves keys once, so polling can work with handles. Unknown keys are left out. */
+        std::vector<TagHandle> handles(const std::span<const TagID> tagIDs) const {
+            std::vector<TagHandle> result;
+            result.reserve(tagIDs.size());
+            for (const TagID &tagID: tagIDs)
+                if (const TagHandle found = tagsDatabase.find(tagID); found != TagDatabase::InvalidHandle)
+                    result.push_back(found);
+            return result;
+        }
+
+        /** @brief Polls the groups added to polling until stopPolling(); blocks the calling thread. */
+        void runPolling() {
+            polling.run(*this);
+        }
+
+        /** @brief Makes runPolling() return after the poll in progress. Can be called from any thread. */
+        void stopPolling() {
+            polling.stop();
+        }
 
         using TagRef = std::reference_wrapper<const Tag>;
 
-        RegisterBuffer read(const uint8_t slave_ID, std::span<const TagRef> tags) {
+        /** @brief Reads the tags, one RegisterBuffer per request, in register order. */
+        std::vector<RegisterBuffer> read(const uint8_t slave_ID, std::span<const TagRef> tags) {
             std::vector<Request> requests = prepareReadRequests(tags);
             std::vector<RegisterBuffer> resp;
+            resp.reserve(requests.size());
             for (auto [registerType, startAddress, quantity]: requests) {
                 RegisterBuffer& buf = resp.emplace_back(startAddress,registerType,quantity);
                 MasterBase::read(slave_ID,buf.view());
             }
+            return resp;
         }
 
-        RegisterBuffer read(const uint8_t slave_ID, std::initializer_list<TagRef> tags) {
+        std::vector<RegisterBuffer> read(const uint8_t slave_ID, std::initializer_list<TagRef> tags) {
             return read(slave_ID, std::span(tags));
         }
 
@@ -107,6 +258,38 @@ namespace eModbus {
             // return {};
         }
 
+        /**
+         * @brief Same as above with requests and result allocated from resource. Responses are received straight
+         * into the result, so with a reset-per-cycle buffer resource a poll cycle does not touch the heap.
+         * A request answered with an exception keeps its slots (zero), so later values stay where they belong;
+         * statuses, if given, gets one exception code per request, 0 for the ones that succeeded.
+         */
+        std::pmr::vector<uint16_t> read(const uint8_t slave_ID, const std::span<TagID> tagIDs,
+                                        std::pmr::memory_resource *resource,
+                                        std::pmr::vector<Frame::ExceptionCode> *statuses = nullptr) {
+            const std::pmr::vector<Request> requests = prepareReadRequests(tagIDs, resource);
+            size_t total = 0;
+            for (const Request &request: requests)
+                total += request.quantity;
+            std::pmr::vector<uint16_t> responses(total, 0, resource);
+            if (statuses)
+                statuses->assign(requests.size(), Frame::ExceptionCode{});
+            size_t offset = 0;
+            for (size_t index = 0; index < requests.size(); ++index) {
+                const Request &request = requests[index];
+                try {
+                    MasterBase::read(slave_ID, RegisterBufferView(request.startAddress, request.registerType,
+                                                                  std::span(responses).subspan(
+                                                                      offset, request.quantity)));
+                } catch (ModbusException &e) {
+                    if (statuses)
+                        (*statuses)[index] = e._exception_code;
+                }
+                offset += request.quantity;
+            }
+            return responses;
+        }
+
         // TagValueMap read(std::initializer_list<TagID>tagIDs) {
         //     //check cache for ready requests
         //
@@ -122,15 +305,24 @@ namespace eModbus {
 
         void write(TagValueMap values);
 
-        static MasterTag TCP(IStreamDevice &serial_device) {
-            MasterTag result(serial_device);
-            result.isTCP = true;
+        static MasterTag TCP(IStreamDevice &serial_device,
+                             std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+            MasterTag result(serial_device, resource);
+            result.transport = Transport::TCP;
+            return result;
+        }
+
+        static MasterTag RTU(IStreamDevice &serial_device,
+                             std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+            MasterTag result(serial_device, resource);
+            result.transport = Transport::RTU;
             return result;
         }
 
-        static MasterTag RTU(IStreamDevice &serial_device) {
-            MasterTag result(serial_device);
-            result.isTCP = false;
+        static MasterTag RTUoverTCP(IStreamDevice &serial_device,
+                             std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+            MasterTag result(serial_device, resource);
+            result.transport = Transport::RTUoverTCP;
             return result;
         }
 
@@ -138,142 +330,143 @@ namespace eModbus {
         //Potrzebuje, zeby tagsDatabase bylo jednoczesnie szybkie do znalezienia przez TagID, oraz przez registerNumber
         // i RegisterType. Najlepiej jeśli jeszcze byłoby posortowane według registerNumber i RegisterType
 
-        std::vector<Tag> tagsDatabase;
-        TagMap IDtoTagMap;
-        std::set<TagID> excludedTags; //moze powinno to byc excludedregisters?
-        std::array<std::set<uint16_t>, 4> excludedRegisters;
-        bool excludedTagsChanged;
-
-        void sortTags(std::vector<TagID> &tags) {
-            std::ranges::sort(tags, [this](const TagID &a_id, const TagID &b_id) {
-                bool a_found = IDtoTagMap.contains(a_id);
-                bool b_found = IDtoTagMap.contains(b_id);
-
-                // If neither tag is found, treat them as equivalent
-                if (!a_found && !b_found) return false;
-                if (!a_found) return false; // Treat 'a' as greater if not found
-                if (!b_found) return true; // Treat 'b' as greater if not found
-
-                const Tag &a = getTag(a_id);
-                const Tag &b = getTag(b_id);
-                // Both tags are found, perform normal comparison
-                return (a.register_type < b.register_type) ||
-                       (a.register_type == b.register_type && a.register_number < b.register_number);
-            });
+        TagDatabase tagsDatabase;
+        /** by handle */
+        std::vector<bool> excludedTags; //moze powinno to byc excludedregisters?
+        ReadPlanner::ExcludedRegisters excludedRegisters;
+        /** by fingerprint of slave and tag set; node based, so references handed out stay put */
+        std::unordered_multimap<uint64_t, ReadPlan> readPlans;
+        /** readPlan() calls so far, stamps ReadPlan::lastUse_ */
+        uint64_t planUses = 0;
+
+        static uint64_t fingerprintOf(const uint8_t slave_ID, const std::span<const TagHandle> tags) {
+            // FNV-1a
+            uint64_t hash = 0xCBF29CE484222325ull;
+            auto mix = [&hash](const uint64_t value) {
+                hash = (hash ^ value) * 0x100000001B3ull;
+            };
+            mix(slave_ID);
+            for (const TagHandle tag: tags)
+                mix(tag);
+            return hash;
         }
 
+        ReadPlan compilePlan(const uint8_t slave_ID, const std::span<const TagHandle> tags,
+                             const uint64_t fingerprint, const ReadCostModel &model) const {
+            ReadPlan plan;
+            plan.slaveID_ = slave_ID;
+            plan.fingerprint_ = fingerprint;
+            plan.costModel_ = model;
+            plan.tags_.assign(tags.begin(), tags.end());
+            planReadRequests(plannerFor(model), tags, plan.requests_);
+
+            plan.requestOffsets_.reserve(plan.requests_.size() + 1);
+            plan.encodedOffsets_.reserve(plan.requests_.size() + 1);
+            plan.frames_.reserve(plan.requests_.size());
+            uint32_t offset = 0;
+            for (const Request &request: plan.requests_) {
+                plan.requestOffsets_.push_back(offset);
+                offset += request.quantity;
+                Frame frame = Frame::build(true, slave_ID, getFunctionCode(true, request.registerType),
+                                           request.startAddress, request.quantity);
+                const std::span<const uint8_t> encoded = encodeRequest(frame);
+                plan.encodedOffsets_.push_back(static_cast<uint32_t>(plan.encoded_.size()));
+                plan.encoded_.insert(plan.encoded_.end(), encoded.begin(), encoded.end());
+                plan.frames_.push_back(frame);
+            }
+            plan.requestOffsets_.push_back(offset);
+            plan.encodedOffsets_.push_back(static_cast<uint32_t>(plan.encoded_.size()));
 
-        bool checkRegistersContinuity(const TagID &first_tag_id, const TagID &end_tag_id) noexcept {
-            if (first_tag_id == end_tag_id)
-                return true;
-            if (!IDtoTagMap.contains(first_tag_id) || !IDtoTagMap.contains(end_tag_id))
-                return false;
-
-            // return true;
-            /** tak naprawde najlepszym algorytmem bylo by wziecie pierwszego taga i przeiterowanie
-             * po kolei po wszystkich tagach następnych i aktualizowanie jak daleko "siega" ten register length
-             **/
-            /** OK czyli potrzebuje tak czy inaczej, zeby wszystkie tagi w db były posortowane według numeru rejestru
-             * i typu rejestru bo inaczej to nie ma sensu. Czyli poniższe powinno działać, jesli zamienic iteratory na
-             * iteratory do glownej bazy a nie mapy ? Najlepiej byloby gdyby to byla jednak mapa
-             */
-
-            auto currentTagIterator = IDtoTagMap.find(first_tag_id);
-            auto endTagIterator = IDtoTagMap.find(end_tag_id);
-
-            auto &previousTag = currentTagIterator->second;
-            auto &endTag = endTagIterator->second;
-            // if (previousTag.register_type != endTag.register_type)
-            //     return false;
-            // if (previousTag.register_number < endTag.register_number)
-            //     return false;
-            //
-            //
-            // int currentRegisterEnd = previousTag.register_number + previousTag.register_length;
-            // ++currentTagIterator;
-            //
-            // for (;currentTagIterator != endTagIterator; ++currentTagIterator) {
-            //     //We reached end of database
-            //     if (currentTagIterator == IDtoTagMap.end())
-            //         return false;
-            //
-            //     const auto& currentTag = currentTagIterator->second;
-            //     if (currentTag.register_type != previousTag.register_type)
-            //         return false;
-            //     if (previousTag.register_number > currentRegisterEnd)
-            //         return false;
-            //
-            //     int newRegisterEnd = currentTag.register_number + currentTag.register_length;
-            //     if (newRegisterEnd > currentRegisterEnd)
-            //         currentRegisterEnd = newRegisterEnd;
-            //
-            // }
-            //we reached end iterator successfuly
-            return true;
+            // requests are ordered by register type and start address, a tag lies in the last one starting at or before it
+            for (const TagHandle tag: tags) {
+                if (!tagsDatabase.contains(tag) || excludedTags[tag])
+                    continue;
+                const RegisterType registerType = tagsDatabase.registerType(tag);
+                const uint16_t registerNumber = tagsDatabase.registerNumber(tag);
+                const auto after = std::ranges::upper_bound(plan.requests_, std::pair{registerType, registerNumber},
+                                                            {}, [](const Request &request) {
+                                                                return std::pair{request.registerType, request.startAddress};
+                                                            });
+                const auto request = static_cast<size_t>(after - plan.requests_.begin()) - 1;
+                plan.slots_.push_back({
+                    tag, static_cast<uint16_t>(request), tagsDatabase.registerLength(tag),
+                    plan.requestOffsets_[request] + (registerNumber - plan.requests_[request].startAddress)
+                });
+            }
+            return plan;
         }
 
-        std::vector<Request> prepareReadRequests(std::span<TagID> tags) {
-            std::vector<Request> requests;
+        auto resolved(std::span<TagID> tags) const {
+            return tags
+                   | std::views::transform([this](const TagID &tagID) { return tagsDatabase.find(tagID); })
+                   | std::views::filter([](const TagHandle tag) { return tag != TagDatabase::InvalidHandle; });
+        }
 
-            if (tags.empty())return requests;
+        /** @brief ReadItems of sorted handles, straight from the database's hot arrays. */
+        struct HandleItems {
+            const TagDatabase &database;
+            std::span<const TagHandle> handles;
 
-            // sortTags(tags);
-            TagID previousTagID{};
-            for (const TagID &currentTagID: tags) {
-                if (!IDtoTagMap.contains(currentTagID))
-                    continue;
-                if (excludedTags.contains(currentTagID))
-                    continue;
+            size_t size() const {
+                return handles.size();
+            }
 
-                const Tag &currentTag = getTag(currentTagID);
-
-                if (requests.empty())
-                    requests.push_back({
-                        .registerType = currentTag.register_type,
-                        .startAddress = currentTag.register_number,
-                        .quantity = currentTag.register_length,
-                    });
-
-                Request &currentRequest = requests.back();
-
-                bool isSameType = currentRequest.registerType == currentTag.register_type;
-                int distance = currentTag.register_number - currentRequest.startAddress;
-                //Check if the distance between the first register in the request and this one is less then the maximum for requests
-                uint16_t currentRegisterEnd = std::max(
-                    distance + currentTag.register_length, static_cast<int>(currentRequest.quantity));
-                bool registerOffsetLessThanMax = currentRegisterEnd <= eModbus::MAX_MODBUS_REGISTERS;
-
-                //Check if registers are continuous (if they are not, then the modbus client can reject request)
-                bool registersSpaceContinuous = checkRegistersContinuity(previousTagID, currentTagID);
-
-                //Add new position to existing request
-                if (isSameType && registerOffsetLessThanMax && registersSpaceContinuous) {
-                    // uint16_t last_tag_position = current_request.valueCount() - previous_tag.register_length;
-                    // current_request.setValueCount(last_tag_position  + register_offset + current_tag.register_length);//increase size of the register to pull
-                    currentRequest.quantity = currentRegisterEnd; //increase size of the register to pull
-                } else {
-                    requests.push_back({
-                        .registerType = currentTag.register_type,
-                        .startAddress = currentTag.register_number,
-                        .quantity = currentTag.register_length
-                    });
-                }
+            ReadItem operator[](const size_t index) const {
+                const TagHandle tag = handles[index];
+                return {database.registerType(tag), database.registerNumber(tag), database.registerLength(tag)};
             }
+        };
 
+        ReadPlanner plannerFor(const ReadCostModel &model) const {
+            ReadPlanner planner = readPlanner;
+            planner.costModel = model;
+            return planner;
+        }
+
+        /** @brief Works on the database's hot arrays only, the tags' strings are never touched. */
+        template<typename Handles, typename Requests>
+        void planReadRequests(const ReadPlanner &planner, Handles &&tags, Requests &requests,
+                              std::pmr::memory_resource *scratch = std::pmr::get_default_resource()) const {
+            std::pmr::vector<TagHandle> planned(scratch);
+            for (const TagHandle tag: tags)
+                if (tagsDatabase.contains(tag) && !excludedTags[tag])
+                    planned.push_back(tag);
+            // handle order is register order; callers usually pass them sorted already
+            if (!std::ranges::is_sorted(planned))
+                std::ranges::sort(planned);
+            planned.erase(std::unique(planned.begin(), planned.end()), planned.end());
+            planner.plan(HandleItems{tagsDatabase, planned}, excludedRegisters, requests, scratch);
+        }
+
+    public:
+        /**
+         * @brief Groups the tags into the read requests with the least bus time under costModel().
+         * Public for benchmarks and custom drivers.
+         */
+        std::vector<Request> prepareReadRequests(std::span<const TagHandle> tags) const {
+            std::vector<Request> requests;
+            planReadRequests(plannerFor(costModel()), tags, requests);
             return requests;
         }
 
-        bool checkForExcludedRegisters(const RegisterType registerType, uint16_t firstRegisterNumber,uint16_t lastRegisterNumber) const {
-            if (firstRegisterNumber > lastRegisterNumber)
-                std::swap(firstRegisterNumber,lastRegisterNumber);
-            bool excludedRegistersFound = false;
-            for (const auto excludedRegisterNumber: excludedRegisters[static_cast<int>(registerType)]) {
-                if (excludedRegisterNumber >= firstRegisterNumber && excludedRegisterNumber <= lastRegisterNumber) {
-                    excludedRegistersFound = true;
-                    break;
-                }
-            }
-            return excludedRegistersFound;
+        std::pmr::vector<Request> prepareReadRequests(std::span<const TagHandle> tags,
+                                                      std::pmr::memory_resource *resource) const {
+            std::pmr::vector<Request> requests(resource);
+            planReadRequests(plannerFor(costModel()), tags, requests, resource);
+            return requests;
+        }
+
+        /** @brief Same by keys, each looked up once. Unknown keys are skipped. */
+        std::vector<Request> prepareReadRequests(std::span<TagID> tags) const {
+            std::vector<Request> requests;
+            planReadRequests(plannerFor(costModel()), resolved(tags), requests);
+            return requests;
+        }
+
+        std::pmr::vector<Request> prepareReadRequests(std::span<TagID> tags, std::pmr::memory_resource *resource) const {
+            std::pmr::vector<Request> requests(resource);
+            planReadRequests(plannerFor(costModel()), resolved(tags), requests, resource);
+            return requests;
         }
 
         std::vector<Request> prepareReadRequests(const std::span<const TagRef> tags) const {
@@ -288,44 +481,13 @@ namespace eModbus {
                 return (a.register_type < b.register_type) ||
                        (a.register_type == b.register_type && a.register_number < b.register_number);
             });
-            TagID previousTagID{};
-            for (const Tag currentTag: tags) {
-                if (requests.empty())
-                    requests.push_back({
-                        .registerType = currentTag.register_type,
-                        .startAddress = currentTag.register_number,
-                        .quantity = currentTag.register_length,
-                    });
-
-                Request &currentRequest = requests.back();
-
-                bool isSameType = currentRequest.registerType == currentTag.register_type;
-                int distance = currentTag.register_number - currentRequest.startAddress;
-                //Check if the distance between the first register in the request and this one is less then the maximum for requests
-                uint16_t currentRegisterEnd = std::max(
-                    distance + currentTag.register_length, static_cast<int>(currentRequest.quantity));
-                bool registerOffsetLessThanMax = currentRegisterEnd <= eModbus::MAX_MODBUS_REGISTERS;
-
-                //Add new position to existing request
-                if (isSameType && registerOffsetLessThanMax
-                    && checkForExcludedRegisters(currentRequest.registerType,
-                        currentRequest.startAddress, currentTag.register_number)) {
-                    currentRequest.quantity = currentRegisterEnd; //increase size of the register to pull
-                } else {
-                    requests.push_back({
-                        .registerType = currentTag.register_type,
-                        .startAddress = currentTag.register_number,
-                        .quantity = currentTag.register_length
-                    });
-                }
-            }
-
+            std::vector<ReadItem> items;
+            items.reserve(sortedTags.size());
+            for (const Tag &tag: sortedTags)
+                items.push_back({tag.register_type, tag.register_number, tag.register_length});
+            plannerFor(costModel()).plan(items, excludedRegisters, requests);
             return requests;
         }
-
-        Tag &getTag(const TagID &tagID) {
-            return tagsDatabase[IDtoTagMap.at(tagID)];
-        }
     };
 }
 
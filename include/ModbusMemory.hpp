@@ -0,0 +1,105 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSMEMORY_HPP
+#define MODBUSMEMORY_HPP
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace eModbus {
+    /**
+     * @brief std::pmr memory resource that forwards to an upstream resource and counts what goes through it.
+     * Put it under the containers of a poll cycle (or make it the default resource) to check that the steady
+     * state allocates nothing: take statistics() after warm-up and compare after the next cycles.
+     * With std::pmr::null_memory_resource() as upstream any allocation throws std::bad_alloc right where it happens.
+     */
+    class CountingMemoryResource : public std::pmr::memory_resource {
+    public:
+        struct Statistics {
+            uint64_t allocations = 0;
+            uint64_t deallocations = 0;
+            uint64_t bytesAllocated = 0;
+            uint64_t bytesInUse = 0;
+            uint64_t peakBytesInUse = 0;
+        };
+
+        explicit CountingMemoryResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+            : upstream_{upstream} {
+        }
+
+        Statistics statistics() const {
+            return {
+                .allocations = allocations_.load(std::memory_order_relaxed),
+                .deallocations = deallocations_.load(std::memory_order_relaxed),
+                .bytesAllocated = bytesAllocated_.load(std::memory_order_relaxed),
+                .bytesInUse = bytesInUse_.load(std::memory_order_relaxed),
+                .peakBytesInUse = peakBytesInUse_.load(std::memory_order_relaxed),
+            };
+        }
+
+        /** @brief Zeroes the counters, bytesInUse is kept since those blocks are still out. */
+        void resetStatistics() {
+            allocations_.store(0, std::memory_order_relaxed);
+            deallocations_.store(0, std::memory_order_relaxed);
+            bytesAllocated_.store(0, std::memory_order_relaxed);
+            peakBytesInUse_.store(bytesInUse_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+
+        std::pmr::memory_resource *upstream() const {
+            return upstream_;
+        }
+
+    private:
+        std::pmr::memory_resource *upstream_;
+        std::atomic<uint64_t> allocations_{0};
+        std::atomic<uint64_t> deallocations_{0};
+        std::atomic<uint64_t> bytesAllocated_{0};
+        std::atomic<uint64_t> bytesInUse_{0};
+        std::atomic<uint64_t> peakBytesInUse_{0};
+
+        void *do_allocate(const size_t bytes, const size_t alignment) override {
+            void *result = upstream_->allocate(bytes, alignment);
+            allocations_.fetch_add(1, std::memory_order_relaxed);
+            bytesAllocated_.fetch_add(bytes, std::memory_order_relaxed);
+            const uint64_t in_use = bytesInUse_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+            uint64_t peak = peakBytesInUse_.load(std::memory_order_relaxed);
+            while (in_use > peak
+                   && !peakBytesInUse_.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+            }
+            return result;
+        }
+
+        void do_deallocate(void *pointer, const size_t bytes, const size_t alignment) override {
+            upstream_->deallocate(pointer, bytes, alignment);
+            deallocations_.fetch_add(1, std::memory_order_relaxed);
+            bytesInUse_.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    /** @brief Makes resource the std::pmr default resource for the lifetime of the object. */
+    class ScopedDefaultResource {
+    public:
+        explicit ScopedDefaultResource(std::pmr::memory_resource *resource)
+            : previous_{std::pmr::set_default_resource(resource)} {
+        }
+
+        ~ScopedDefaultResource() {
+            std::pmr::set_default_resource(previous_);
+        }
+
+        ScopedDefaultResource(const ScopedDefaultResource &) = delete;
+        ScopedDefaultResource &operator=(const ScopedDefaultResource &) = delete;
+
+    private:
+        std::pmr::memory_resource *previous_;
+    };
+}
+
+#endif //MODBUSMEMORY_HPP
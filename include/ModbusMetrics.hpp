@@ -0,0 +1,336 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSMETRICS_HPP
+#define MODBUSMETRICS_HPP
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Instrumentation is opt-in: build with EMODBUS_METRICS=1 (CMake option EMODBUS_METRICS) to let MasterBase feed
+ * a Metrics object. Without it the probes in the master compile to nothing. The Metrics class itself is always
+ * available, e.g. for drivers that want to record into it on their own.
+ */
+#ifndef EMODBUS_METRICS
+#define EMODBUS_METRICS 0
+#endif
+
+namespace eModbus {
+    /**
+     * @brief HDR-style latency histogram in microseconds: log2 major buckets split into linear sub-buckets,
+     * so the relative error stays below 1/SubBuckets over the whole range (1 us .. ~9 min).
+     * Recording is one relaxed atomic increment, readers take a snapshot without locking.
+     */
+    class LatencyHistogram {
+    public:
+        static constexpr uint32_t SubBucketBits = 3;
+        static constexpr uint32_t SubBuckets = 1u << SubBucketBits;
+        static constexpr uint32_t MaxExponent = 26;
+        static constexpr uint32_t BucketCount = (MaxExponent + 1) * SubBuckets;
+
+        struct Snapshot {
+            std::array<uint32_t, BucketCount> counts{};
+            uint64_t count = 0;
+            uint64_t sum_us = 0;
+            uint32_t max_us = 0;
+
+            double mean_us() const {
+                return count ? static_cast<double>(sum_us) / static_cast<double>(count) : 0.0;
+            }
+
+            /** @brief Upper bound of the bucket holding the given percentile (0..100). */
+            uint32_t percentile_us(const double percentile) const {
+                if (count == 0)
+                    return 0;
+                const auto rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count - 1)) + 1;
+                uint64_t seen = 0;
+                for (uint32_t bucket = 0; bucket < BucketCount; ++bucket) {
+                    seen += counts[bucket];
+                    if (seen >= rank)
+                        return std::min(bucketUpperBound(bucket), max_us);
+                }
+                return max_us;
+            }
+        };
+
+        static constexpr uint32_t bucketIndex(const uint32_t value_us) {
+            if (value_us < SubBuckets)
+                return value_us;
+            const uint32_t exponent = std::bit_width(value_us) - 1 - SubBucketBits + 1;
+            if (exponent > MaxExponent)
+                return BucketCount - 1;
+            const uint32_t sub_bucket = (value_us >> (exponent - 1)) - SubBuckets;
+            return exponent * SubBuckets + sub_bucket;
+        }
+
+        static constexpr uint32_t bucketUpperBound(const uint32_t bucket) {
+            const uint32_t exponent = bucket / SubBuckets;
+            const uint32_t sub_bucket = bucket % SubBuckets;
+            if (exponent == 0)
+                return sub_bucket;
+            return ((SubBuckets + sub_bucket + 1) << (exponent - 1)) - 1;
+        }
+
+        void record(const uint32_t value_us) {
+            counts_[bucketIndex(value_us)].fetch_add(1, std::memory_order_relaxed);
+            count_.fetch_add(1, std::memory_order_relaxed);
+            sum_us_.fetch_add(value_us, std::memory_order_relaxed);
+            uint32_t current_max = max_us_.load(std::memory_order_relaxed);
+            while (value_us > current_max
+                   && !max_us_.compare_exchange_weak(current_max, value_us, std::memory_order_relaxed)) {
+            }
+        }
+
+        Snapshot snapshot() const {
+            Snapshot result;
+            for (uint32_t bucket = 0; bucket < BucketCount; ++bucket)
+                result.counts[bucket] = counts_[bucket].load(std::memory_order_relaxed);
+            result.count = count_.load(std::memory_order_relaxed);
+            result.sum_us = sum_us_.load(std::memory_order_relaxed);
+            result.max_us = max_us_.load(std::memory_order_relaxed);
+            return result;
+        }
+
+        void reset() {
+            for (auto &count: counts_)
+                count.store(0, std::memory_order_relaxed);
+            count_.store(0, std::memory_order_relaxed);
+            sum_us_.store(0, std::memory_order_relaxed);
+            max_us_.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::array<std::atomic<uint32_t>, BucketCount> counts_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> sum_us_{0};
+        std::atomic<uint32_t> max_us_{0};
+    };
+
+    /**
+     * @brief Transaction metrics of one master/bus: error counters and round trip histograms per slave and per
+     * function code, plus send/turnaround/receive histograms and bus occupancy.
+     *
+     * Per-slave and per-function-code blocks are allocated on first use, so a bus with three slaves costs three
+     * blocks. All recording is lock-free; snapshot(), toText() and toJson() can run on any thread at any time.
+     */
+    class Metrics {
+    public:
+        enum class Counter : uint8_t {
+            Transactions,
+            Timeouts,
+            InvalidFrames,
+            CrcErrors,
+            Exceptions,
+            StreamFailures,
+            Retries,
+            Count
+        };
+
+        static constexpr size_t CounterCount = static_cast<size_t>(Counter::Count);
+        /** every uint8_t: TCP unit IDs go up to 255 (gateways commonly answer as 255), past RTU's 247 */
+        static constexpr size_t SlaveCount = 256;
+        static constexpr size_t FunctionCodeCount = 128;
+        using Clock = std::chrono::steady_clock;
+
+        struct Timings {
+            uint32_t send_us;
+            uint32_t turnaround_us;
+            uint32_t receive_us;
+            /** time the line actually carried request and response */
+            uint32_t wire_us;
+        };
+
+        struct Block {
+            std::array<std::atomic<uint64_t>, CounterCount> counters{};
+            LatencyHistogram roundTrip;
+        };
+
+        struct BlockSnapshot {
+            std::array<uint64_t, CounterCount> counters{};
+            LatencyHistogram::Snapshot roundTrip;
+        };
+
+        struct Snapshot {
+            double elapsed_s = 0;
+            double busOccupancy = 0;
+            BlockSnapshot total;
+            LatencyHistogram::Snapshot send;
+            LatencyHistogram::Snapshot turnaround;
+            LatencyHistogram::Snapshot receive;
+            /** only slaves / function codes that were seen, as (id, block) */
+            std::vector<std::pair<uint8_t, BlockSnapshot>> slaves;
+            std::vector<std::pair<uint8_t, BlockSnapshot>> functionCodes;
+        };
+
+        Metrics() = default;
+        Metrics(const Metrics &) = delete;
+        Metrics &operator=(const Metrics &) = delete;
+
+        ~Metrics() {
+            for (auto &block: slaves_)
+                delete block.load(std::memory_order_relaxed);
+            for (auto &block: functionCodes_)
+                delete block.load(std::memory_order_relaxed);
+        }
+
+        void count(const Counter counter, const uint8_t slave_ID, const uint8_t function_code) {
+            const auto index = static_cast<size_t>(counter);
+            total_.counters[index].fetch_add(1, std::memory_order_relaxed);
+            slaveBlock(slave_ID).counters[index].fetch_add(1, std::memory_order_relaxed);
+            functionCodeBlock(function_code).counters[index].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void recordTransaction(const uint8_t slave_ID, const uint8_t function_code, const Timings &timings) {
+            const uint32_t round_trip = timings.send_us + timings.turnaround_us + timings.receive_us;
+            count(Counter::Transactions, slave_ID, function_code);
+            total_.roundTrip.record(round_trip);
+            slaveBlock(slave_ID).roundTrip.record(round_trip);
+            functionCodeBlock(function_code).roundTrip.record(round_trip);
+            send_.record(timings.send_us);
+            turnaround_.record(timings.turnaround_us);
+            receive_.record(timings.receive_us);
+            busy_us_.fetch_add(timings.wire_us, std::memory_order_relaxed);
+        }
+
+        /** @brief Line time not tied to a completed transaction (failed attempts, broadcasts). */
+        void recordBusTime(const uint32_t wire_us) {
+            busy_us_.fetch_add(wire_us, std::memory_order_relaxed);
+        }
+
+        Snapshot snapshot() const;
+
+        std::string toText() const;
+
+        std::string toJson() const;
+
+        /** @brief Zeroes counters and histograms. Not atomic with respect to concurrent recording. */
+        void reset();
+
+    private:
+        Block total_;
+        LatencyHistogram send_;
+        LatencyHistogram turnaround_;
+        LatencyHistogram receive_;
+        std::atomic<uint64_t> busy_us_{0};
+        std::atomic<int64_t> start_ns_{Clock::now().time_since_epoch().count()};
+        std::array<std::atomic<Block *>, SlaveCount> slaves_{};
+        std::array<std::atomic<Block *>, FunctionCodeCount> functionCodes_{};
+
+        /** index has to be below N, the callers' types make sure it is */
+        template<size_t N>
+        static Block &lazyBlock(std::array<std::atomic<Block *>, N> &blocks, const size_t index) {
+            std::atomic<Block *> &slot = blocks[index];
+            Block *block = slot.load(std::memory_order_acquire);
+            if (block)
+                return *block;
+            auto created = std::make_unique<Block>();
+            if (slot.compare_exchange_strong(block, created.get(), std::memory_order_acq_rel))
+                return *created.release();
+            return *block;
+        }
+
+        static_assert(SlaveCount > std::numeric_limits<uint8_t>::max());
+
+        Block &slaveBlock(const uint8_t slave_ID) {
+            return lazyBlock(slaves_, slave_ID);
+        }
+
+        Block &functionCodeBlock(const uint8_t function_code) {
+            return lazyBlock(functionCodes_, function_code & 0x7F);
+        }
+
+        static BlockSnapshot snapshotOf(const Block &block);
+    };
+
+    /**
+     * @brief Measures one master transaction and reports it to Metrics. With EMODBUS_METRICS=0 MasterBase
+     * uses NullTransactionProbe instead, which has the same interface and no body.
+     */
+    class TransactionProbe {
+    public:
+        TransactionProbe(Metrics *metrics, const uint8_t slave_ID, const uint8_t function_code)
+            : metrics_{metrics}, slaveID_{slave_ID}, functionCode_{function_code}, started_{Metrics::Clock::now()},
+              sent_{started_} {
+        }
+
+        /** @brief Request is on the wire. request_wire_us is its transmission time at the current baud rate. */
+        void sent(const uint32_t request_wire_us) {
+            sent_ = Metrics::Clock::now();
+            requestWire_us_ = request_wire_us;
+        }
+
+        /** @brief Response is in. response_wire_us is its transmission time, the rest of the wait is turnaround. */
+        void received(const uint32_t response_wire_us) {
+            if (!metrics_)
+                return;
+            const uint32_t waited = elapsed_us(sent_, Metrics::Clock::now());
+            const uint32_t receive_us = std::min(waited, response_wire_us);
+            metrics_->recordTransaction(slaveID_, functionCode_, {
+                                            .send_us = elapsed_us(started_, sent_),
+                                            .turnaround_us = waited - receive_us,
+                                            .receive_us = receive_us,
+                                            .wire_us = requestWire_us_ + receive_us,
+                                        });
+        }
+
+        void failed(const Metrics::Counter reason) {
+            if (!metrics_)
+                return;
+            metrics_->count(reason, slaveID_, functionCode_);
+            metrics_->recordBusTime(requestWire_us_);
+        }
+
+        void count(const Metrics::Counter counter) {
+            if (metrics_)
+                metrics_->count(counter, slaveID_, functionCode_);
+        }
+
+    private:
+        Metrics *metrics_;
+        uint8_t slaveID_;
+        uint8_t functionCode_;
+        Metrics::Clock::time_point started_;
+        Metrics::Clock::time_point sent_;
+        uint32_t requestWire_us_ = 0;
+
+        static uint32_t elapsed_us(const Metrics::Clock::time_point from, const Metrics::Clock::time_point to) {
+            return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+        }
+    };
+
+    class NullTransactionProbe {
+    public:
+        constexpr NullTransactionProbe(Metrics *, uint8_t, uint8_t) {
+        }
+
+        constexpr void sent(uint32_t) {
+        }
+
+        constexpr void received(uint32_t) {
+        }
+
+        constexpr void failed(Metrics::Counter) {
+        }
+
+        constexpr void count(Metrics::Counter) {
+        }
+    };
+
+#if EMODBUS_METRICS
+    using MasterTransactionProbe = TransactionProbe;
+#else
+    using MasterTransactionProbe = NullTransactionProbe;
+#endif
+}
+
+#endif //MODBUSMETRICS_HPP
@@ -0,0 +1,170 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSPOLLSCHEDULER_HPP
+#define MODBUSPOLLSCHEDULER_HPP
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "ModbusTagDatabase.hpp"
+
+namespace eModbus {
+    class MasterTag;
+
+    /**
+     * @brief Multi-rate polling of tag groups over one bus, earliest deadline first.
+     *
+     * Every group is released once per period and has to be read before its next release. pollOnce() takes the
+     * released group with the earliest deadline, together with every other released group of the same slave,
+     * and reads their tags with one MasterTag::readPlan(), so groups that fall due together share requests.
+     *
+     * The bus time each group takes is measured on every poll. When the groups ask for more than
+     * targetUtilization of the bus, the periods are stretched starting from the highest priority number, just
+     * enough to fit: a 60 s config group goes slow first, the 100 ms alarms keep their period. Priority 0 is
+     * never stretched. Periods go back to nominal once the measured load allows it.
+     *
+     * A poll is not interrupted. A group released while a long one is on the bus waits for it, so a group read
+     * in 250 ms makes a 100 ms group miss; split big groups, or put them on another bus.
+     *
+     * Groups are added and removed from the polling thread, not from within the callbacks. The callbacks must
+     * not change the master's tags or exclusions while a poll runs, the plan being read would be dropped.
+     */
+    class PollScheduler {
+    public:
+        using GroupID = uint32_t;
+        using Handle = TagDatabase::Handle;
+
+        struct Group {
+            uint8_t slaveID = 1;
+            std::vector<Handle> tags;
+            uint32_t period_us = 1000000;
+            /** 0 is the most important; under overload the highest numbers are stretched first */
+            uint8_t priority = 0;
+        };
+
+        struct GroupStatistics {
+            uint64_t polls = 0;
+            /** polls completed after the next release */
+            uint64_t deadlineMisses = 0;
+            uint64_t errors = 0;
+            /** period_us, stretched under overload */
+            uint32_t effectivePeriod_us = 0;
+            /** moving average of the group's share of the bus time of its polls */
+            uint32_t averageCost_us = 0;
+            /** release to completion of the last poll */
+            uint32_t lastResponse_us = 0;
+        };
+
+        /** Called for every tag read, registers as in MasterTag::read(const ReadPlan &, ...). */
+        using UpdateCallback = std::function<void(uint8_t slave_ID, Handle tag, std::span<const uint16_t> registers)>;
+        /**
+         * Called for every group of a poll with a tag in a failed request (the first such error); the group is
+         * released again one period later. Its tags in requests that went through are still updated.
+         */
+        using ErrorCallback = std::function<void(GroupID group, const std::exception &error)>;
+
+        /** share of the bus the groups may take before periods get stretched */
+        double targetUtilization = 0.9;
+        /** longest a period gets under overload, in multiples of period_us */
+        double maxStretch = 16.0;
+
+        /** Clock of the releases and deadlines, steady_clock by default. Replace both for virtual time. */
+        std::function<uint64_t()> now_us;
+        std::function<void(uint64_t time_us)> sleepUntil_us;
+
+        PollScheduler();
+
+        /** @brief Adds a group, released right away. */
+        GroupID addGroup(Group group);
+
+        void removeGroup(GroupID group);
+
+        void clear();
+
+        size_t groupsCount() const {
+            return groups_.size();
+        }
+
+        void onUpdate(UpdateCallback callback) {
+            onUpdate_ = std::move(callback);
+        }
+
+        void onError(ErrorCallback callback) {
+            onError_ = std::move(callback);
+        }
+
+        /**
+         * @brief Polls the released group with the earliest deadline and the released groups sharing its slave.
+         * @return number of groups polled, 0 if none was released yet
+         */
+        size_t pollOnce(MasterTag &master);
+
+        /** @brief When the next group is released; UINT64_MAX without groups. */
+        uint64_t nextRelease_us() const;
+
+        /** @brief Polls until stop(), sleeping until the next release in between. */
+        void run(MasterTag &master);
+
+        /** @brief Makes run() return after the poll in progress. Can be called from any thread. */
+        void stop() {
+            stopped_->store(true, std::memory_order_relaxed);
+        }
+
+        /** @brief Bus share the groups ask for at their nominal periods, from the measured costs. */
+        double utilization() const;
+
+        /** @throws std::out_of_range for an unknown group */
+        const GroupStatistics &statistics(GroupID group) const;
+
+    private:
+        struct Entry {
+            GroupID id;
+            Group group;
+            uint64_t release_us = 0;
+            double stretch = 1.0;
+            double cost_us = 0.0;
+            GroupStatistics statistics;
+
+            uint64_t period_us() const {
+                return static_cast<uint64_t>(group.period_us * stretch);
+            }
+
+            uint64_t deadline_us() const {
+                return release_us + period_us();
+            }
+        };
+
+        /** waits are cut to this, so stop() is seen even when the next release is a minute away */
+        static constexpr uint64_t MaxSleep_us = 50000;
+
+        std::vector<Entry> groups_;
+        GroupID nextID_ = 0;
+        UpdateCallback onUpdate_;
+        ErrorCallback onError_;
+        /** behind a pointer so the scheduler, and the MasterTag holding it, stay movable */
+        std::unique_ptr<std::atomic<bool>> stopped_ = std::make_unique<std::atomic<bool>>(false);
+
+        // reused between polls
+        std::vector<size_t> batch_;
+        std::vector<Handle> tags_;
+        std::vector<uint16_t> registers_;
+        /** by request of the plan being polled, null if it went through */
+        std::vector<std::exception_ptr> failures_;
+        /** (tag, request) of the tags in failed requests, sorted by tag */
+        std::vector<std::pair<Handle, uint16_t>> failedTags_;
+
+        /** @return the first failure among the group's tags, null if all of them were read */
+        std::exception_ptr failureOf(const Group &group) const;
+
+        void adaptPeriods();
+    };
+}
+
+#endif //MODBUSPOLLSCHEDULER_HPP
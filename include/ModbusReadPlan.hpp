@@ -0,0 +1,95 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSREADPLAN_HPP
+#define MODBUSREADPLAN_HPP
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "ModbusFrame.hpp"
+#include "ModbusReadPlanner.hpp"
+#include "ModbusTagDatabase.hpp"
+
+namespace eModbus {
+    /**
+     * @brief Compiled reads of one tag set on one slave: the requests, their frames already encoded for the
+     * master's transport, and where every tag ends up in the registers read.
+     *
+     * The registers of all requests land back to back in one buffer of registerCount(); tagRegisters() is the
+     * part that belongs to the i-th tag of the set, in the order the set was given. Built and cached by
+     * MasterTag::readPlan(), so a poll cycle only sends the frames and copies the responses.
+     */
+    class ReadPlan {
+    public:
+        /** @brief Place of a tag in the register buffer. */
+        struct Slot {
+            TagDatabase::Handle tag;
+            uint16_t request;
+            uint16_t registerCount;
+            uint32_t offset;
+        };
+
+        uint8_t slaveID() const {
+            return slaveID_;
+        }
+
+        uint64_t fingerprint() const {
+            return fingerprint_;
+        }
+
+        std::span<const ReadRequest> requests() const {
+            return requests_;
+        }
+
+        /** @brief Where the registers of request i start in the register buffer. */
+        uint32_t requestOffset(const size_t request) const {
+            return requestOffsets_[request];
+        }
+
+        size_t registerCount() const {
+            return requestOffsets_.empty() ? 0 : requestOffsets_.back();
+        }
+
+        /** @brief Encoded ADU of request i. */
+        std::span<const uint8_t> encoded(const size_t request) const {
+            return std::span<const uint8_t>(encoded_).subspan(encodedOffsets_[request],
+                                                              encodedOffsets_[request + 1] - encodedOffsets_[request]);
+        }
+
+        const Frame &frame(const size_t request) const {
+            return frames_[request];
+        }
+
+        /** @brief One slot per tag of the set, in its order; tags the plan does not read are left out. */
+        std::span<const Slot> slots() const {
+            return slots_;
+        }
+
+        std::span<const uint16_t> tagRegisters(const std::span<const uint16_t> registers, const size_t slot) const {
+            return registers.subspan(slots_[slot].offset, slots_[slot].registerCount);
+        }
+
+    private:
+        friend class MasterTag;
+
+        uint8_t slaveID_ = 0;
+        uint64_t fingerprint_ = 0;
+        /** the bus it was planned for */
+        ReadCostModel costModel_;
+        /** for evicting the least recently used plan */
+        uint64_t lastUse_ = 0;
+        /** the tag set as given, to tell fingerprint collisions apart */
+        std::vector<TagDatabase::Handle> tags_;
+        std::vector<ReadRequest> requests_;
+        /** size requests_ + 1, the last one is registerCount() */
+        std::vector<uint32_t> requestOffsets_;
+        std::vector<Frame> frames_;
+        std::vector<uint8_t> encoded_;
+        std::vector<uint32_t> encodedOffsets_;
+        std::vector<Slot> slots_;
+    };
+}
+
+#endif //MODBUSREADPLAN_HPP
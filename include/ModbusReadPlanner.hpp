@@ -0,0 +1,166 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSREADPLANNER_HPP
+#define MODBUSREADPLANNER_HPP
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <set>
+#include <vector>
+
+#include "ModbusFrame.hpp"
+#include "ModbusUtils.hpp"
+
+namespace eModbus {
+    /** @brief One read request of a plan. */
+    struct ReadRequest {
+        RegisterType registerType;
+        uint16_t startAddress;
+        uint16_t quantity;
+    };
+
+    /** @brief What the planner needs to know about a tag. */
+    struct ReadItem {
+        RegisterType registerType;
+        uint16_t registerNumber;
+        uint16_t registerLength;
+    };
+
+    /**
+     * @brief Bus time of one read transaction: request and response on the wire, the t3.5 gap before each
+     * and the slave's turnaround. Reading a gap costs its bytes, a separate request costs all the rest.
+     */
+    struct ReadCostModel {
+        /** 0 for links where bytes are free compared to a round trip (TCP) */
+        uint32_t baudrate = 9600;
+        uint32_t turnaround_us = 2000;
+        /** RTU read request: slave ID, function code, address, quantity, CRC */
+        uint16_t requestBytes = 8;
+        /** RTU read response without the data: slave ID, function code, byte count, CRC */
+        uint16_t responseHeaderBytes = 5;
+
+        static constexpr uint32_t payloadBytes(const RegisterType registerType, const uint32_t quantity) {
+            return registerType == RegisterType::Coil || registerType == RegisterType::DiscreteInput
+                       ? (quantity + 7) / 8
+                       : quantity * 2;
+        }
+
+        constexpr uint32_t requestCost_us(const RegisterType registerType, const uint32_t quantity) const {
+            const size_t bytes = requestBytes + responseHeaderBytes + payloadBytes(registerType, quantity);
+            const uint32_t gaps = baudrate ? 2 * Frame::t35_us(baudrate) : 0;
+            return Frame::transmissionTime_us(bytes, baudrate) + gaps + turnaround_us;
+        }
+
+        static constexpr ReadCostModel RTU(const uint32_t baudrate, const uint32_t turnaround_us = 2000) {
+            return {baudrate, turnaround_us};
+        }
+
+        static constexpr ReadCostModel TCP(const uint32_t round_trip_us = 1000) {
+            return {0, round_trip_us};
+        }
+
+        constexpr bool operator==(const ReadCostModel &) const = default;
+    };
+
+    /**
+     * @brief Splits sorted tags into read requests with the least total bus time.
+     *
+     * Dynamic programming over the tags: best[j] is the cheapest way to read tags 0..j-1, and the last request
+     * of it reads tags i..j-1 for the i that minimizes best[i] + cost(request). A request holds tags of one
+     * register type, spans at most maxQuantity registers and never covers an excluded register, except a single
+     * tag that overlaps one itself (it was asked for). Whether a gap gets bridged follows from the cost model:
+     * at 9600 baud a separate request costs as much as reading about 10 gap registers, over TCP gaps are free.
+     */
+    class ReadPlanner {
+    public:
+        using ExcludedRegisters = std::array<std::set<uint16_t>, 4>;
+
+        ReadCostModel costModel;
+        uint16_t maxQuantity = MAX_MODBUS_REGISTERS;
+
+        /**
+         * @brief Appends the requests for items to requests.
+         * @param items random access, items[i] gives a ReadItem, sorted by register type and number
+         * @param scratch backs the DP tables (2 words per item)
+         */
+        template<typename Items, typename Requests>
+        void plan(const Items &items, const ExcludedRegisters &excluded, Requests &requests,
+                  std::pmr::memory_resource *scratch = std::pmr::get_default_resource()) const {
+            const size_t count = std::size(items);
+            if (count == 0)
+                return;
+            constexpr uint64_t Unreachable = std::numeric_limits<uint64_t>::max();
+            // requestCost_us split into a fixed part per type and a per byte part, in ns, out of the inner loop
+            std::array<uint64_t, 4> fixed_ns{};
+            for (size_t type = 0; type < fixed_ns.size(); ++type)
+                fixed_ns[type] = 1000ull * costModel.requestCost_us(static_cast<RegisterType>(type), 0);
+            const uint64_t byte_ns = costModel.baudrate
+                                         ? (Frame::BITS_PER_CHARACTER * 1000000000ull + costModel.baudrate - 1)
+                                           / costModel.baudrate
+                                         : 0;
+
+            // bus time in ns of the best plan for the first j items
+            std::pmr::vector<uint64_t> best(count + 1, Unreachable, scratch);
+            std::pmr::vector<size_t> first(count + 1, 0, scratch);
+            best[0] = 0;
+
+            for (size_t j = 1; j <= count; ++j) {
+                const ReadItem last = items[j - 1];
+                const std::set<uint16_t> &excludedOfType = excluded[static_cast<size_t>(last.registerType)];
+                const uint64_t fixed = fixed_ns[static_cast<size_t>(last.registerType)];
+                uint32_t end = 0;
+                for (size_t i = j; i-- > 0;) {
+                    const ReadItem item = items[i];
+                    if (item.registerType != last.registerType)
+                        break;
+                    end = std::max<uint32_t>(end, static_cast<uint32_t>(item.registerNumber) + item.registerLength);
+                    const uint32_t quantity = end - item.registerNumber;
+                    const bool single = i == j - 1;
+                    if (!single && (quantity > maxQuantity
+                                    || (!excludedOfType.empty() && coversExcluded(excludedOfType, item.registerNumber, end))))
+                        break;
+                    if (best[i] == Unreachable)
+                        continue;
+                    const uint64_t cost = best[i] + fixed + byte_ns * ReadCostModel::payloadBytes(last.registerType, quantity);
+                    if (cost < best[j]) {
+                        best[j] = cost;
+                        first[j] = i;
+                    }
+                }
+            }
+
+            const size_t appended = std::size(requests);
+            for (size_t j = count; j > 0; j = first[j]) {
+                const size_t i = first[j];
+                uint32_t end = 0;
+                for (size_t k = i; k < j; ++k)
+                    end = std::max<uint32_t>(end, static_cast<uint32_t>(items[k].registerNumber) + items[k].registerLength);
+                const ReadItem head = items[i];
+                requests.push_back({head.registerType, head.registerNumber,
+                                    static_cast<uint16_t>(end - head.registerNumber)});
+            }
+            std::reverse(requests.begin() + static_cast<std::ptrdiff_t>(appended), requests.end());
+        }
+
+        /** @brief Total bus time of requests under the cost model. */
+        template<typename Requests>
+        uint64_t cost_us(const Requests &requests) const {
+            uint64_t total = 0;
+            for (const ReadRequest &request: requests)
+                total += costModel.requestCost_us(request.registerType, request.quantity);
+            return total;
+        }
+
+    private:
+        static bool coversExcluded(const std::set<uint16_t> &excluded, const uint16_t start, const uint32_t end) {
+            const auto it = excluded.lower_bound(start);
+            return it != excluded.end() && *it < end;
+        }
+    };
+}
+
+#endif //MODBUSREADPLANNER_HPP
@@ -4,6 +4,7 @@
 
 #ifndef MODBUSREGISTERBUFFER_HPP
 #define MODBUSREGISTERBUFFER_HPP
+#include <array>
 #include <cstdint>
 #include <span>
 #include <stdexcept>
@@ -125,6 +126,50 @@ namespace eModbus {
         RegisterType registerType_;
         std::vector<RegistersValueType> registersValue_; // 2. The data is owned by this class.
     };
+
+    /**
+     * @brief RegisterBuffer with the registers in a std::array of N, no heap. numRegisters may be less than N,
+     * view() covers only those.
+     */
+    template<size_t N>
+    class StaticRegisterBuffer {
+    public:
+        using RegistersValueType = uint16_t;
+        static_assert(N > 0 && N <= 0xFFFF, "StaticRegisterBuffer holds 1..65535 registers");
+
+        constexpr StaticRegisterBuffer(uint16_t startAddress, RegisterType registerType, uint16_t numRegisters = N)
+            : startAddress_{startAddress},
+              registerType_(registerType),
+              numRegisters_{numRegisters} {
+            if (numRegisters > N) {
+                throw std::out_of_range("numRegisters exceeds StaticRegisterBuffer capacity");
+            }
+        }
+
+        constexpr RegisterBufferView view() {
+            return RegisterBufferView(startAddress_, registerType_,
+                                      std::span<RegistersValueType>(registersValue_.data(), numRegisters_));
+        }
+
+        template<typename T, eModbus::ByteOrder Order = eModbus::ByteOrder::MSB>
+        constexpr void put(uint16_t modbus_address, const T& value) {
+            view().template put<T, Order>(modbus_address, value);
+        }
+
+        template<typename T, eModbus::ByteOrder Order = eModbus::ByteOrder::MSB>
+        constexpr T get(uint16_t modbus_address){
+            return view().template get<T, Order>(modbus_address);
+        }
+
+        static constexpr size_t capacity() {
+            return N;
+        }
+
+        uint16_t startAddress_;
+        RegisterType registerType_;
+        uint16_t numRegisters_;
+        std::array<RegistersValueType, N> registersValue_{};
+    };
 }
 
 #endif //MODBUSREGISTERBUFFER_HPP
\ No newline at end of file
@@ -0,0 +1,167 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSREGISTERIMAGE_HPP
+#define MODBUSREGISTERIMAGE_HPP
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <span>
+
+#include "ModbusUtils.hpp"
+
+namespace eModbus {
+    /**
+     * @brief Sparse image of all four register types of one slave over the whole 0..65535 address space.
+     *
+     * Registers live in 64-register pages allocated from the memory resource when first written; the page of an
+     * address is found through a two-level directory in constant time. Every page keeps a bitmap of the registers
+     * that exist and one of the registers that changed since the last clearDirty(), so a write-back or a publisher
+     * only has to look at forEachDirtyRange(). Coils and discrete inputs are stored like MasterBase reads them,
+     * 0xFF00/0x0000.
+     *
+     * Not synchronized: one thread owns the image.
+     */
+    class RegisterImage {
+    public:
+        static constexpr uint32_t PageSize = 64;
+        static constexpr uint32_t PagesPerDirectory = 16;
+        static constexpr uint32_t DirectoriesPerType = 0x10000 / (PageSize * PagesPerDirectory);
+        static constexpr size_t TypeCount = 4;
+
+        struct Page {
+            std::array<uint16_t, PageSize> values{};
+            uint64_t present = 0;
+            uint64_t dirty = 0;
+        };
+
+        explicit RegisterImage(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : _resource{resource} {
+        }
+
+        ~RegisterImage() {
+            clear();
+        }
+
+        RegisterImage(const RegisterImage &) = delete;
+        RegisterImage &operator=(const RegisterImage &) = delete;
+
+        RegisterImage(RegisterImage &&other) noexcept
+            : _resource{other._resource}, _directories{other._directories}, _pages{other._pages} {
+            other._directories = {};
+            other._pages = 0;
+        }
+
+        /**
+         * @brief Stores values from start_address on; registers whose value changed (or that are new) get dirty.
+         * @return number of registers that changed
+         */
+        size_t write(RegisterType register_type, uint16_t start_address, std::span<const uint16_t> values,
+                     bool mark_dirty = true);
+
+        /** @brief Copies values.size() registers, missing ones read as 0. @return false if any was missing */
+        bool read(RegisterType register_type, uint16_t start_address, std::span<uint16_t> values) const;
+
+        std::optional<uint16_t> get(const RegisterType register_type, const uint16_t address) const {
+            const Page *found = page(register_type, address / PageSize);
+            const uint32_t bit = address % PageSize;
+            if (found == nullptr || !(found->present >> bit & 1))
+                return std::nullopt;
+            return found->values[bit];
+        }
+
+        /** @return true if the value changed */
+        bool set(const RegisterType register_type, const uint16_t address, const uint16_t value,
+                 const bool mark_dirty = true) {
+            return write(register_type, address, std::span<const uint16_t>(&value, 1), mark_dirty) != 0;
+        }
+
+        bool contains(const RegisterType register_type, const uint16_t address) const {
+            const Page *found = page(register_type, address / PageSize);
+            return found != nullptr && (found->present >> address % PageSize & 1);
+        }
+
+        bool isDirty(const RegisterType register_type, const uint16_t address) const {
+            const Page *found = page(register_type, address / PageSize);
+            return found != nullptr && (found->dirty >> address % PageSize & 1);
+        }
+
+        /**
+         * @brief Calls f(start_address, quantity) for every run of dirty registers in address order,
+         * runs crossing pages joined and split at max_quantity (e.g. one write request each).
+         */
+        template<typename F>
+        void forEachDirtyRange(const RegisterType register_type, F &&f,
+                               const uint32_t max_quantity = MAX_MODBUS_REGISTERS) const {
+            uint32_t run_start = 0;
+            uint32_t run_length = 0;
+            auto extend = [&](const uint32_t address, uint32_t count) {
+                if (run_length != 0 && run_start + run_length != address) {
+                    f(static_cast<uint16_t>(run_start), static_cast<uint16_t>(run_length));
+                    run_length = 0;
+                }
+                for (uint32_t at = address; count != 0;) {
+                    if (run_length == 0)
+                        run_start = at;
+                    const uint32_t taken = std::min(count, max_quantity - run_length);
+                    run_length += taken;
+                    at += taken;
+                    count -= taken;
+                    if (run_length == max_quantity) {
+                        f(static_cast<uint16_t>(run_start), static_cast<uint16_t>(run_length));
+                        run_length = 0;
+                    }
+                }
+            };
+            for (uint32_t page_index = 0; page_index < 0x10000 / PageSize; ++page_index) {
+                const Page *current = page(register_type, page_index);
+                if (current == nullptr)
+                    continue;
+                uint64_t mask = current->dirty;
+                while (mask != 0) {
+                    const auto first = static_cast<uint32_t>(std::countr_zero(mask));
+                    const auto ones = static_cast<uint32_t>(std::countr_one(mask >> first));
+                    extend(page_index * PageSize + first, ones);
+                    mask = first + ones >= 64 ? 0 : mask & ~((uint64_t{1} << (first + ones)) - 1);
+                }
+            }
+            if (run_length != 0)
+                f(static_cast<uint16_t>(run_start), static_cast<uint16_t>(run_length));
+        }
+
+        void clearDirty(RegisterType register_type, uint16_t start_address, uint32_t quantity);
+
+        /** @brief Marks everything clean. */
+        void clearDirty();
+
+        /** @brief Pages allocated so far, PageSize registers each. */
+        size_t pageCount() const {
+            return _pages;
+        }
+
+        /** @brief Frees all pages. */
+        void clear();
+
+    private:
+        struct Directory {
+            std::array<Page *, PagesPerDirectory> pages{};
+        };
+
+        std::pmr::memory_resource *_resource;
+        std::array<Directory *, TypeCount * DirectoriesPerType> _directories{};
+        size_t _pages = 0;
+
+        Page *page(const RegisterType register_type, const uint32_t page_index) const {
+            const Directory *directory = _directories[static_cast<size_t>(register_type) * DirectoriesPerType
+                                                      + page_index / PagesPerDirectory];
+            return directory == nullptr ? nullptr : directory->pages[page_index % PagesPerDirectory];
+        }
+
+        Page &pageForWrite(RegisterType register_type, uint32_t page_index);
+    };
+}
+
+#endif //MODBUSREGISTERIMAGE_HPP
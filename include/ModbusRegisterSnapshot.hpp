@@ -0,0 +1,148 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSREGISTERSNAPSHOT_HPP
+#define MODBUSREGISTERSNAPSHOT_HPP
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include "ModbusRegisterBuffer.hpp"
+#include "ModbusUtils.hpp"
+
+namespace eModbus {
+    /**
+     * @brief Register block published by one writer (the bus thread) and read by any number of threads
+     * without locking.
+     *
+     * A seqlock: publish() makes the sequence odd, stores the registers and makes it even again; a reader copies
+     * the registers between two loads of the sequence and starts over if it changed or was odd. A copy is therefore
+     * always one whole publish, a float or a block of registers is never half old and half new. Readers never
+     * block the writer, the writer never waits for readers.
+     *
+     * The registers are relaxed atomics, so the copies are free of data races without any fence on the data itself.
+     *
+     *   // bus thread                               // any other thread
+     *   master.read(slave_ID, poll.view());         float voltage = snapshot.get<float>(0x0000);
+     *   snapshot.publish(poll.view());              snapshot.read(0x0000, block);
+     */
+    class SnapshotRegisterBuffer {
+    public:
+        static constexpr size_t CacheLineSize = 64;
+
+        SnapshotRegisterBuffer(const uint16_t startAddress, const RegisterType registerType,
+                               const uint16_t numRegisters)
+            : startAddress_{startAddress}, registerType_{registerType}, size_{numRegisters},
+              registers_{std::make_unique<std::atomic<uint16_t>[]>(numRegisters)} {
+        }
+
+        SnapshotRegisterBuffer(const SnapshotRegisterBuffer &) = delete;
+        SnapshotRegisterBuffer &operator=(const SnapshotRegisterBuffer &) = delete;
+
+        uint16_t startAddress() const {
+            return startAddress_;
+        }
+
+        RegisterType registerType() const {
+            return registerType_;
+        }
+
+        uint16_t size() const {
+            return size_;
+        }
+
+        /** @brief Number of publishes so far; a reader can compare it to see whether anything new arrived. */
+        uint64_t version() const {
+            return sequence_.load(std::memory_order_acquire) / 2;
+        }
+
+        /** @brief Writer only. Stores registers from modbus_address on as one update. */
+        void publish(const uint16_t modbus_address, const std::span<const uint16_t> registers) {
+            const size_t offset = calculate_offset(modbus_address, registers.size());
+            const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+            sequence_.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < registers.size(); ++i)
+                registers_[offset + i].store(registers[i], std::memory_order_relaxed);
+            sequence_.store(sequence + 2, std::memory_order_release);
+        }
+
+        /** @brief Writer only. Publishes a polled block; it may cover all of this buffer or a part of it. */
+        void publish(const RegisterBufferView &view) {
+            if (view.registerType() != registerType_)
+                throw std::invalid_argument("Register type does not match the snapshot buffer");
+            publish(view.startAddress(), view.buffer());
+        }
+
+        /**
+         * @brief One attempt at a consistent copy of destination.size() registers from modbus_address on.
+         * @return false if a publish ran meanwhile (destination holds garbage then)
+         */
+        bool tryRead(const uint16_t modbus_address, const std::span<uint16_t> destination,
+                     uint64_t *version_out = nullptr) const {
+            const size_t offset = calculate_offset(modbus_address, destination.size());
+            const uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1)
+                return false;
+            for (size_t i = 0; i < destination.size(); ++i)
+                destination[i] = registers_[offset + i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) != before)
+                return false;
+            if (version_out != nullptr)
+                *version_out = before / 2;
+            return true;
+        }
+
+        /** @brief Consistent copy of destination.size() registers from modbus_address on. @return its version */
+        uint64_t read(const uint16_t modbus_address, const std::span<uint16_t> destination) const {
+            uint64_t version = 0;
+            while (!tryRead(modbus_address, destination, &version)) {
+            }
+            return version;
+        }
+
+        /** @brief Consistent copy of the whole block into a RegisterBuffer of the same layout (allocates). */
+        RegisterBuffer snapshot() const {
+            RegisterBuffer copy(startAddress_, registerType_, size_);
+            read(startAddress_, copy.registersValue_);
+            return copy;
+        }
+
+        /** @brief Value at modbus_address, all of its registers from the same publish. */
+        template<typename T, eModbus::ByteOrder Order = eModbus::ByteOrder::MSB>
+        T get(const uint16_t modbus_address) const {
+            static_assert(std::is_arithmetic_v<T> && sizeof(T) <= 8, "Read strings and byte arrays with read()");
+            // exactly the registers of the value, one that runs past the block throws rather than reading zeros
+            constexpr size_t Count = (sizeof(T) + 1) / 2;
+            std::array<uint16_t, Count> window{};
+            read(modbus_address, window);
+            return convertFromRegisters<T, Order>(window);
+        }
+
+    private:
+        const uint16_t startAddress_;
+        const RegisterType registerType_;
+        const uint16_t size_;
+        std::unique_ptr<std::atomic<uint16_t>[]> registers_;
+
+        /** even when stable, odd while a publish is in progress; written by the writer only */
+        alignas(CacheLineSize) std::atomic<uint64_t> sequence_{0};
+
+        size_t calculate_offset(const uint16_t modbus_address, const size_t count) const {
+            if (modbus_address < startAddress_)
+                throw std::out_of_range("Modbus address is below buffer start address.");
+            const size_t offset = modbus_address - startAddress_;
+            if (offset + count > size_)
+                throw std::out_of_range("Modbus address exceeds buffer size");
+            return offset;
+        }
+    };
+}
+
+#endif //MODBUSREGISTERSNAPSHOT_HPP
@@ -0,0 +1,84 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSRETRYPOLICY_HPP
+#define MODBUSRETRYPOLICY_HPP
+#include <algorithm>
+#include <cstdint>
+
+#include "ModbusFrame.hpp"
+
+namespace eModbus {
+    /**
+     * @brief When and how MasterBase repeats a failed transaction. The already encoded request bytes are sent again,
+     * the frame is not rebuilt. The default (maxAttempts = 1) never retries.
+     *
+     * Only idempotent requests (reads) are retried unless retryWrites is set: a write whose response was lost
+     * may already have been executed by the slave.
+     */
+    struct RetryPolicy {
+        enum Reason : uint8_t {
+            CrcError = 1 << 0,
+            Timeout = 1 << 1,
+            SlaveDeviceBusy = 1 << 2,
+            Acknowledge = 1 << 3,
+            InvalidFrame = 1 << 4,
+        };
+
+        /** attempts in total, the first one included */
+        uint8_t maxAttempts = 1;
+        /** Reason flags that are worth another attempt */
+        uint8_t retryOn = CrcError | Timeout | SlaveDeviceBusy | Acknowledge;
+        bool retryWrites = false;
+        /** wait before the second attempt, doubled for every next one up to maxBackoff_us */
+        uint32_t backoff_us = 5000;
+        uint32_t maxBackoff_us = 200000;
+        /** part of the wait (0..1) replaced by a random one, so masters sharing a gateway do not retry in step */
+        float jitter = 0.5f;
+
+        static constexpr bool isIdempotent(const Frame::FunctionCode function_code) {
+            switch (function_code) {
+                case Frame::ReadCoils:
+                case Frame::ReadDiscreteInputs:
+                case Frame::ReadHoldingRegisters:
+                case Frame::ReadInputRegisters:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        /** @brief Reason for an exception response, 0 when the exception is final. */
+        static constexpr uint8_t reasonFor(const Frame::ExceptionCode exception_code) {
+            switch (exception_code) {
+                case Frame::SlaveDeviceBusy:
+                    return SlaveDeviceBusy;
+                case Frame::Acknowledge:
+                    return Acknowledge;
+                default:
+                    return 0;
+            }
+        }
+
+        bool allows(const Frame::FunctionCode function_code) const {
+            return maxAttempts > 1 && (retryWrites || isIdempotent(function_code));
+        }
+
+        /** @brief attempt (1 based) failed for reason: is there another one? */
+        bool shouldRetry(const uint8_t attempt, const uint8_t reason) const {
+            return attempt < maxAttempts && (retryOn & reason) != 0;
+        }
+
+        /** @brief Wait after the given failed attempt (1 based); random is any uniformly distributed value. */
+        uint32_t backoff(const uint8_t attempt, const uint32_t random) const {
+            const uint32_t shift = std::min<uint32_t>(attempt - 1, 16);
+            const uint32_t full = static_cast<uint32_t>(
+                std::min<uint64_t>(static_cast<uint64_t>(backoff_us) << shift, maxBackoff_us));
+            const auto jittered = static_cast<uint32_t>(static_cast<float>(full) * std::clamp(jitter, 0.0f, 1.0f));
+            return full - jittered + (jittered ? random % (jittered + 1) : 0);
+        }
+    };
+}
+
+#endif //MODBUSRETRYPOLICY_HPP
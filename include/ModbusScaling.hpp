@@ -0,0 +1,103 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSSCALING_HPP
+#define MODBUSSCALING_HPP
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "ModbusRegisterBuffer.hpp"
+#include "ModbusTag.hpp"
+#include "ModbusUtils.hpp"
+
+namespace eModbus {
+    /**
+     * @brief Turns a polled register block into engineering values of its tags, all at once.
+     *
+     * Built once per block and tag list: the tags are grouped by register_value_type, and every group keeps its
+     * register offsets, scales and limits in plain arrays. decode() then runs one tight loop per group without
+     * strings, branches on the type or lookups.
+     *
+     * Integer types are divided by 10^precision, FLOAT is taken as is, BOOL is 0 or 1 and U8 is the low byte.
+     * When min_value < max_value the result is clamped to that range and flagged. ASCII and BYTE_ARRAY tags
+     * have no numeric value, they decode to NaN flagged NotNumeric.
+     */
+    class ScalingPlan {
+    public:
+        enum Flag : uint8_t {
+            InRange = 0,
+            BelowMin = 1,
+            AboveMax = 2,
+            NotNumeric = 4,
+        };
+
+        ScalingPlan() = default;
+
+        /**
+         * @brief Plans the tags of one block. Output index i is tags[i].
+         * @throws std::out_of_range if a tag is not inside the block or of another register type
+         */
+        ScalingPlan(uint16_t startAddress, RegisterType registerType, uint16_t numRegisters,
+                    std::span<const Tag> tags);
+
+        size_t size() const {
+            return tagCount_;
+        }
+
+        uint16_t startAddress() const {
+            return startAddress_;
+        }
+
+        RegisterType registerType() const {
+            return registerType_;
+        }
+
+        /**
+         * @brief Writes the value of every tag to values and its Flag bits to flags (may be empty).
+         * @throws std::out_of_range if the block or the outputs are smaller than planned
+         */
+        void decode(std::span<const uint16_t> registers, std::span<double> values,
+                    std::span<uint8_t> flags = {}) const;
+
+        void decode(const RegisterBufferView &block, const std::span<double> values,
+                    const std::span<uint8_t> flags = {}) const {
+            if (block.registerType() != registerType_ || block.startAddress() != startAddress_)
+                throw std::out_of_range("Register block does not match the scaling plan");
+            decode(block.buffer(), values, flags);
+        }
+
+    private:
+        enum Kind : uint8_t {
+            U16,
+            U32,
+            Float,
+            LowByte,
+            HighByte,
+            Bool,
+            Text,
+            KindCount,
+        };
+
+        /** tags of one kind, structure of arrays */
+        struct Group {
+            std::vector<uint32_t> output;
+            std::vector<uint16_t> offset;
+            std::vector<double> scale;
+            std::vector<double> min;
+            std::vector<double> max;
+        };
+
+        uint16_t startAddress_ = 0;
+        RegisterType registerType_ = RegisterType::Holding;
+        uint16_t numRegisters_ = 0;
+        size_t tagCount_ = 0;
+        std::array<Group, KindCount> groups_;
+
+        static Kind kindOf(Tag::modbus_parameter_type type);
+    };
+}
+
+#endif //MODBUSSCALING_HPP
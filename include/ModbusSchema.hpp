@@ -0,0 +1,190 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSSCHEMA_HPP
+#define MODBUSSCHEMA_HPP
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include "ModbusConvert.hpp"
+#include "ModbusRegisterBuffer.hpp"
+#include "ModbusUtils.hpp"
+
+namespace eModbus {
+    /**
+     * Register map of a device model declared at compile time, e.g.
+     *
+     *   struct Meter { float voltage; float current; uint32_t energy; bool relay; };
+     *   using MeterMap = RegisterMap<Meter,
+     *       Field<&Meter::voltage, RegisterType::AnalogInput, 0x0000, WordOrder::CDAB>,
+     *       Field<&Meter::current, RegisterType::AnalogInput, 0x0006, WordOrder::CDAB>,
+     *       Field<&Meter::energy, RegisterType::Holding, 0x0100>,
+     *       Field<&Meter::relay, RegisterType::Coil, 0>>;
+     *
+     *   MeterMap::Image image;                  // registers of all requests back to back
+     *   for (auto &request : MeterMap::requests) ... read into MeterMap::block(image, request)
+     *   Meter meter = MeterMap::decode(image);  // or MeterMap::read(master, slave_ID)
+     *
+     * The read requests (one per run of registers of one type, at most MAX_MODBUS_REGISTERS each) and the position
+     * of every field in the image are computed by the compiler, so decode() and encode() are straight-line code
+     * with constant offsets. Coil and discrete input fields are bool, one register (0xFF00/0x0000) each.
+     */
+    template<auto Member, RegisterType Type, uint16_t Address, WordOrder Order = WordOrder::ABCD>
+    struct Field;
+
+    template<typename Struct, typename Value, Value Struct::*Member, RegisterType Type, uint16_t Address,
+        WordOrder Order>
+    struct Field<Member, Type, Address, Order> {
+        static_assert(std::is_same_v<Value, bool> || detail::BulkConvertible<Value>,
+                      "Field type must be bool, a 16/32/64-bit integer, float or double");
+        static_assert(std::is_same_v<Value, bool> == (Type == RegisterType::Coil || Type == RegisterType::DiscreteInput),
+                      "Coils and discrete inputs map to bool fields, registers to numbers");
+
+        using StructType = Struct;
+        using ValueType = Value;
+        static constexpr RegisterType registerType = Type;
+        static constexpr uint16_t address = Address;
+        static constexpr uint16_t words = std::is_same_v<Value, bool> ? 1 : sizeof(Value) / 2;
+
+        static constexpr void decode(Struct &destination, const uint16_t *registers) {
+            if constexpr (std::is_same_v<Value, bool>)
+                destination.*Member = registers[0] != 0;
+            else
+                destination.*Member = detail::fromWords<Value, Order>(registers);
+        }
+
+        static constexpr void encode(const Struct &source, uint16_t *registers) {
+            if constexpr (std::is_same_v<Value, bool>)
+                registers[0] = source.*Member ? 0xFF00 : 0x0000;
+            else
+                detail::toWords<Value, Order>(source.*Member, registers);
+        }
+    };
+
+    /** @brief One read of a register map; offset is where its registers start in the image. */
+    struct SchemaRequest {
+        RegisterType registerType;
+        uint16_t startAddress;
+        uint16_t quantity;
+        uint16_t offset;
+    };
+
+    namespace detail {
+        struct FieldLayout {
+            RegisterType registerType;
+            uint16_t address;
+            uint16_t words;
+        };
+
+        template<size_t N>
+        struct SchemaPlan {
+            std::array<SchemaRequest, N> requests{};
+            size_t count = 0;
+            uint16_t registers = 0;
+        };
+
+        /** @brief Sorts the fields by type and address and merges them into blocks, bridging gaps up to max_gap. */
+        template<size_t N>
+        constexpr SchemaPlan<N> planSchema(std::array<FieldLayout, N> fields, const uint16_t max_gap) {
+            std::sort(fields.begin(), fields.end(), [](const FieldLayout &a, const FieldLayout &b) {
+                return a.registerType != b.registerType ? a.registerType < b.registerType : a.address < b.address;
+            });
+            SchemaPlan<N> plan;
+            for (const FieldLayout &field: fields) {
+                const uint32_t field_end = static_cast<uint32_t>(field.address) + field.words;
+                if (plan.count != 0) {
+                    SchemaRequest &last = plan.requests[plan.count - 1];
+                    const uint32_t last_end = static_cast<uint32_t>(last.startAddress) + last.quantity;
+                    if (last.registerType == field.registerType && field.address <= last_end + max_gap
+                        && field_end - last.startAddress <= MAX_MODBUS_REGISTERS) {
+                        if (field_end > last_end) {
+                            plan.registers += static_cast<uint16_t>(field_end - last_end);
+                            last.quantity = static_cast<uint16_t>(field_end - last.startAddress);
+                        }
+                        continue;
+                    }
+                }
+                plan.requests[plan.count++] = {field.registerType, field.address, field.words, plan.registers};
+                plan.registers += field.words;
+            }
+            return plan;
+        }
+    }
+
+    /** @brief RegisterMap that also reads the registers between fields when the gap is at most MaxGap. */
+    template<typename Struct, uint16_t MaxGap, typename... Fields>
+    class BasicRegisterMap {
+        static_assert(sizeof...(Fields) > 0, "A register map needs at least one field");
+        static_assert((std::is_same_v<typename Fields::StructType, Struct> && ...),
+                      "All fields must be members of the mapped struct");
+
+        static constexpr detail::SchemaPlan<sizeof...(Fields)> plan_ = detail::planSchema<sizeof...(Fields)>(
+            {detail::FieldLayout{Fields::registerType, Fields::address, Fields::words}...}, MaxGap);
+
+        template<typename F>
+        static constexpr uint16_t offsetOf() {
+            for (size_t i = 0; i < plan_.count; ++i) {
+                const SchemaRequest &request = plan_.requests[i];
+                if (request.registerType == F::registerType && F::address >= request.startAddress
+                    && F::address + F::words <= request.startAddress + request.quantity)
+                    return static_cast<uint16_t>(request.offset + F::address - request.startAddress);
+            }
+            return 0;
+        }
+
+        /** image index of field F, a constant so decode() and encode() index the image with immediates */
+        template<typename F>
+        static constexpr uint16_t offset_ = offsetOf<F>();
+
+    public:
+        using StructType = Struct;
+        static constexpr size_t RequestCount = plan_.count;
+        static constexpr size_t RegisterCount = plan_.registers;
+        using Image = std::array<uint16_t, RegisterCount>;
+
+        static constexpr std::array<SchemaRequest, RequestCount> requests = [] {
+            std::array<SchemaRequest, RequestCount> result{};
+            std::copy_n(plan_.requests.begin(), RequestCount, result.begin());
+            return result;
+        }();
+
+        /** @brief Part of the image one request reads into. */
+        static constexpr std::span<uint16_t> block(Image &image, const SchemaRequest &request) {
+            return std::span<uint16_t>(image).subspan(request.offset, request.quantity);
+        }
+
+        static constexpr void decode(const Image &image, Struct &destination) {
+            (Fields::decode(destination, image.data() + offset_<Fields>), ...);
+        }
+
+        static constexpr Struct decode(const Image &image) {
+            Struct result{};
+            decode(image, result);
+            return result;
+        }
+
+        /** @brief Registers not covered by a field (bridged gaps) are left as they are. */
+        static constexpr void encode(const Struct &source, Image &image) {
+            (Fields::encode(source, image.data() + offset_<Fields>), ...);
+        }
+
+        /** @brief Runs all requests on a master (anything with read(slave_ID, RegisterBufferView)) and decodes. */
+        template<typename Master>
+        static Struct read(Master &master, const uint8_t slave_ID) {
+            Image image{};
+            for (const SchemaRequest &request: requests)
+                master.read(slave_ID, RegisterBufferView(request.startAddress, request.registerType,
+                                                         block(image, request)));
+            return decode(image);
+        }
+    };
+
+    template<typename Struct, typename... Fields>
+    using RegisterMap = BasicRegisterMap<Struct, 0, Fields...>;
+}
+
+#endif //MODBUSSCHEMA_HPP
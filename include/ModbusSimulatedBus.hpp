@@ -0,0 +1,169 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSSIMULATEDBUS_HPP
+#define MODBUSSIMULATEDBUS_HPP
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "IStreamDevice.hpp"
+#include "ModbusFrame.hpp"
+#include "ModbusUtils.hpp"
+
+namespace eModbus {
+    /**
+     * @brief Simulated time in microseconds. Only moves when the simulated bus says so,
+     * so a run is deterministic and takes as long as the CPU needs, not as long as the wire would.
+     */
+    class VirtualClock {
+    public:
+        uint64_t now_us() const {
+            return now_us_;
+        }
+
+        void advance(const uint64_t delta_us) {
+            now_us_ += delta_us;
+        }
+
+        void advanceTo(const uint64_t time_us) {
+            if (time_us > now_us_)
+                now_us_ = time_us;
+        }
+
+        double seconds() const {
+            return static_cast<double>(now_us_) / 1e6;
+        }
+
+    private:
+        uint64_t now_us_ = 0;
+    };
+
+    /**
+     * @brief Modbus RTU slave living on a SimulatedBus. Only the registers present in the map exist,
+     * reading or writing anything else gives IllegalDataAddress, like a real device with a sparse map.
+     */
+    struct SimulatedSlave {
+        uint8_t slaveID = 1;
+        uint32_t baudrate = 9600;
+        /** time from the end of the request to the first byte of the response */
+        uint32_t turnaround_us = 2000;
+        std::array<std::map<uint16_t, uint16_t>, 4> registers;
+
+        SimulatedSlave &set(RegisterType register_type, uint16_t start_address, std::span<const uint16_t> values);
+
+        /** @brief Adds `quantity` registers filled with value. */
+        SimulatedSlave &fill(RegisterType register_type, uint16_t start_address, uint16_t quantity,
+                             uint16_t value = 0);
+
+        std::optional<uint16_t> get(RegisterType register_type, uint16_t address) const;
+    };
+
+    /**
+     * @brief In-process RS-485 bus with simulated RTU slaves, implementing IStreamDevice for a master under test.
+     *
+     * Models character time at the current baud rate (11 bits per character), t3.5 silence between frames,
+     * slave turnaround latency, corrupted CRCs and lost responses. All of it runs on a VirtualClock:
+     * write() moves the clock past the request, read() moves it to when the requested bytes would have arrived
+     * (or to the timeout). read() returns early when the response ends, like an idle-line driver.
+     *
+     * Error injection uses its own seeded generator, so the same seed gives the same run.
+     */
+    class SimulatedBus : public IStreamDevice {
+    public:
+        struct Statistics {
+            uint64_t requests = 0;
+            uint64_t responses = 0;
+            uint64_t exceptions = 0;
+            uint64_t unanswered = 0;
+            uint64_t corrupted = 0;
+            uint64_t dropped = 0;
+            uint64_t busBusy_us = 0;
+        };
+
+        /** probability (0..1) that a response gets one byte corrupted */
+        double crcErrorRate = 0.0;
+        /** probability (0..1) that a slave does not answer at all */
+        double dropoutRate = 0.0;
+
+        explicit SimulatedBus(uint32_t baudrate = 9600, uint32_t seed = 1);
+
+        SimulatedSlave &addSlave(uint8_t slave_ID, uint32_t baudrate = 0, uint32_t turnaround_us = 2000);
+
+        SimulatedSlave *slave(uint8_t slave_ID);
+
+        VirtualClock &clock() {
+            return clock_;
+        }
+
+        const Statistics &statistics() const {
+            return statistics_;
+        }
+
+        void resetStatistics() {
+            statistics_ = {};
+        }
+
+        /** @brief Share of the elapsed virtual time the line carried data. */
+        double utilization() const;
+
+        static uint32_t characterTime_us(uint32_t baudrate);
+
+        static uint32_t t35_us(uint32_t baudrate);
+
+        SerialError read(std::span<uint8_t> buffer, uint32_t timeout_ms, size_t *bytes_read_out = nullptr) override;
+
+        SerialError write(std::span<const uint8_t> buffer, uint32_t timeout_ms,
+                          size_t *bytes_written_out = nullptr) override;
+
+        SerialError flush() override;
+
+        /** write() already holds a request back until t3.5 after the line went idle, in virtual time */
+        void interFrameDelay(uint32_t) override {
+        }
+
+        /** a retry backoff passes in virtual time */
+        void delay(const uint32_t delay_us) override {
+            clock_.advance(delay_us);
+        }
+
+        void baudrate(uint32_t baudrate) override {
+            baudrate_ = baudrate;
+        }
+
+        uint32_t baudrate() const override {
+            return baudrate_;
+        }
+
+    private:
+        uint32_t baudrate_;
+        VirtualClock clock_;
+        Statistics statistics_;
+        std::mt19937 random_;
+        std::map<uint8_t, SimulatedSlave> slaves_;
+
+        std::vector<uint8_t> response_;
+        size_t responseDelivered_ = 0;
+        uint64_t responseStart_us_ = 0;
+        uint64_t lineIdleSince_us_ = 0;
+
+        bool chance(double probability);
+
+        void handleRequest(std::span<const uint8_t> request);
+
+        static Frame respond(SimulatedSlave &slave, Frame &request);
+
+        void onTxComplete() override {
+        }
+
+        void onRxComplete(uint16_t size) override {
+        }
+    };
+}
+
+#endif //MODBUSSIMULATEDBUS_HPP
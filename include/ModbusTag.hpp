@@ -6,9 +6,8 @@
 #define MODBUSTAG_H
 #include <string_view>
 
-#include "ModbusMasterBase.hpp"
+#include "ModbusUtils.hpp"
 namespace eModbus {
-    enum class RegisterType;
 
     struct Tag {
         enum class modbus_parameter_type:char {
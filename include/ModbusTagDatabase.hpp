@@ -0,0 +1,112 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSTAGDATABASE_HPP
+#define MODBUSTAGDATABASE_HPP
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ModbusTag.hpp"
+#include "ModbusUtils.hpp"
+
+namespace eModbus {
+    /**
+     * @brief Registered tags addressed by dense integer handles.
+     *
+     * Handles are indices in (register type, register number) order, so sorting handles sorts the tags and a
+     * planner walks neighbouring tags in neighbouring memory. What planning needs (register type, number, length
+     * and value type, 6 bytes per tag) is kept as one array per field; the full Tag with its strings is kept
+     * apart and only touched through metadata(). Keys are interned once in assign(), find() is the only string
+     * hash, done when a caller turns its keys into handles.
+     */
+    class TagDatabase {
+    public:
+        using Handle = uint32_t;
+        static constexpr Handle InvalidHandle = std::numeric_limits<Handle>::max();
+
+        TagDatabase() = default;
+
+        /** The key index points into the stored tags, so copies would dangle. */
+        TagDatabase(const TagDatabase &) = delete;
+        TagDatabase &operator=(const TagDatabase &) = delete;
+        TagDatabase(TagDatabase &&) = default;
+        TagDatabase &operator=(TagDatabase &&) = default;
+
+        /** @brief Replaces the contents with tags, sorted by register type and number. Duplicate keys keep the first. */
+        void assign(std::span<const Tag> tags);
+
+        void clear();
+
+        size_t size() const {
+            return registerTypes_.size();
+        }
+
+        bool empty() const {
+            return registerTypes_.empty();
+        }
+
+        /** @return handle of the tag with key, InvalidHandle if there is none */
+        Handle find(const std::string_view key) const {
+            const auto it = keys_.find(key);
+            return it == keys_.end() ? InvalidHandle : it->second;
+        }
+
+        bool contains(const Handle handle) const {
+            return handle < size();
+        }
+
+        RegisterType registerType(const Handle handle) const {
+            return registerTypes_[handle];
+        }
+
+        uint16_t registerNumber(const Handle handle) const {
+            return registerNumbers_[handle];
+        }
+
+        uint16_t registerLength(const Handle handle) const {
+            return registerLengths_[handle];
+        }
+
+        Tag::modbus_parameter_type valueType(const Handle handle) const {
+            return valueTypes_[handle];
+        }
+
+        /** @brief Everything else about the tag (name, unit, limits...). Not meant for hot loops. */
+        const Tag &metadata(const Handle handle) const {
+            return metadata_[handle];
+        }
+
+        std::span<const RegisterType> registerTypes() const {
+            return registerTypes_;
+        }
+
+        std::span<const uint16_t> registerNumbers() const {
+            return registerNumbers_;
+        }
+
+        std::span<const uint16_t> registerLengths() const {
+            return registerLengths_;
+        }
+
+        std::span<const Tag::modbus_parameter_type> valueTypes() const {
+            return valueTypes_;
+        }
+
+    private:
+        std::vector<RegisterType> registerTypes_;
+        std::vector<uint16_t> registerNumbers_;
+        std::vector<uint16_t> registerLengths_;
+        std::vector<Tag::modbus_parameter_type> valueTypes_;
+
+        std::vector<Tag> metadata_;
+        /** views of the keys in metadata_, which is not resized after assign() */
+        std::unordered_map<std::string_view, Handle> keys_;
+    };
+}
+
+#endif //MODBUSTAGDATABASE_HPP
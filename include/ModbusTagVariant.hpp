@@ -4,26 +4,157 @@
 
 #ifndef MODBUSTAGVARIANT_HPP
 #define MODBUSTAGVARIANT_HPP
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 #include "ModbusRegisterBuffer.hpp"
 #include "ModbusUtils.hpp"
 
 namespace eModbus {
+    /**
+     * @brief Value of a tag kept as its modbus registers.
+     *
+     * Up to InlineCapacity registers (everything but strings and byte arrays) live inside the object, so updating
+     * a numeric tag never touches the heap. Longer values spill to a heap block, which is kept when the value
+     * shrinks again.
+     */
     class TagVariant {
-        std::vector<uint16_t> data; //store variant in modbus registers
-        // eModbus::RegisterBuffer data2;
     public:
+        static constexpr size_t InlineCapacity = 4;
+
         TagVariant() = default;
-        TagVariant(const TagVariant&) = default;
-        TagVariant& operator=(const TagVariant&) = default;
-        TagVariant(TagVariant&&) = default;
-        TagVariant& operator=(TagVariant&&) = default;
-        ~TagVariant() = default;
 
+        explicit TagVariant(const std::span<const uint16_t> registers) {
+            assign(registers);
+        }
+
+        TagVariant(const TagVariant& other) {
+            assign(other.registers());
+        }
+
+        TagVariant& operator=(const TagVariant& other) {
+            if (this != &other)
+                assign(other.registers());
+            return *this;
+        }
+
+        TagVariant(TagVariant&& other) noexcept {
+            steal(other);
+        }
+
+        TagVariant& operator=(TagVariant&& other) noexcept {
+            if (this != &other) {
+                release();
+                steal(other);
+            }
+            return *this;
+        }
+
+        ~TagVariant() {
+            release();
+        }
+
+        void assign(const std::span<const uint16_t> registers) {
+            resize(registers.size());
+            std::copy(registers.begin(), registers.end(), data());
+        }
+
+        /** @brief Added registers are 0. */
+        void resize(const size_t numRegisters) {
+            const uint32_t kept = size_;
+            if (numRegisters > capacity_) {
+                auto *grown = new uint16_t[numRegisters];
+                std::copy_n(data(), kept, grown);
+                release();
+                storage_.heap = grown;
+                capacity_ = static_cast<uint32_t>(numRegisters);
+            }
+            if (numRegisters > kept)
+                std::fill(data() + kept, data() + numRegisters, 0);
+            size_ = static_cast<uint32_t>(numRegisters);
+        }
+
+        std::span<uint16_t> registers() {
+            return {data(), size_};
+        }
+
+        std::span<const uint16_t> registers() const {
+            return {data(), size_};
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+        /** @brief False once the value has spilled to the heap. */
+        bool isInline() const {
+            return capacity_ == InlineCapacity;
+        }
+
+        template<typename T, eModbus::ByteOrder Order = eModbus::ByteOrder::MSB>
+        T get() const {
+            return convertFromRegisters<T, Order>(registers());
+        }
+
+        /** @brief Stores value, growing to the registers it needs (a string or byte array may keep more). */
+        template<typename T, eModbus::ByteOrder Order = eModbus::ByteOrder::MSB>
+        void set(const T& value) {
+            size_t needed = 1;
+            if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<uint8_t>>)
+                needed = (value.size() + 1) / 2;
+            else if constexpr (sizeof(T) > 2)
+                needed = sizeof(T) / 2;
+            if (size_ < needed)
+                resize(needed);
+            convertToRegisters<T, Order>(registers(), value);
+        }
+
+        /** @brief The registers as a buffer at the tag's place, e.g. to read or write them through a master. */
+        RegisterBufferView view(const uint16_t startAddress, const RegisterType registerType) {
+            return RegisterBufferView(startAddress, registerType, registers());
+        }
+
+    private:
+        union Storage {
+            std::array<uint16_t, InlineCapacity> local{};
+            uint16_t *heap;
+        } storage_;
+        uint32_t size_ = 0;
+        uint32_t capacity_ = InlineCapacity;
+
+        uint16_t *data() {
+            return isInline() ? storage_.local.data() : storage_.heap;
+        }
+
+        const uint16_t *data() const {
+            return isInline() ? storage_.local.data() : storage_.heap;
+        }
 
+        void release() {
+            if (!isInline())
+                delete[] storage_.heap;
+            storage_.local = {};
+            size_ = 0;
+            capacity_ = InlineCapacity;
+        }
 
+        void steal(TagVariant& other) {
+            storage_ = other.storage_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.storage_.local = {};
+            other.size_ = 0;
+            other.capacity_ = InlineCapacity;
+        }
     };
 }
-#endif //MODBUSTAGVARIANT_HPP
\ No newline at end of file
+#endif //MODBUSTAGVARIANT_HPP
@@ -0,0 +1,197 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef MODBUSTRACE_HPP
+#define MODBUSTRACE_HPP
+#include <atomic>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * Tracing is opt-in: build with EMODBUS_TRACE=1 (CMake option EMODBUS_TRACE) to turn the EMODBUS_TRACE_* trace
+ * points in Frame, MasterBase and the stream devices into 16 byte records in a per-thread ring.
+ * Without it the macros expand to nothing, arguments included.
+ */
+#ifndef EMODBUS_TRACE
+#define EMODBUS_TRACE 0
+#endif
+
+/** records kept per thread, the oldest are overwritten (power of two) */
+#ifndef EMODBUS_TRACE_RING_SIZE
+#define EMODBUS_TRACE_RING_SIZE 16384
+#endif
+
+namespace eModbus::trace {
+    enum class Event : uint8_t {
+        FrameBuilt,
+        FrameValidated,
+        Transaction,
+        Send,
+        Receive,
+        DeviceWrite,
+        DeviceRead,
+        Count
+    };
+
+    enum class Phase : uint8_t {
+        Instant,
+        Begin,
+        End,
+    };
+
+    const char *to_string(Event event);
+
+    /** @brief One trace point hit. length and detail depend on the event (bytes, SerialError, ValidationStatus). */
+    struct Record {
+        uint64_t timestamp_ns;
+        Event event;
+        Phase phase;
+        uint8_t slaveID;
+        uint8_t functionCode;
+        uint16_t length;
+        uint16_t detail;
+    };
+
+    static_assert(sizeof(Record) == 16);
+
+    struct ThreadRecord {
+        uint32_t thread;
+        Record record;
+    };
+
+    /**
+     * @brief Ring of the records of one thread. Only the owning thread writes, so pushing is a store of the record
+     * and one release store of the head; collect() copies concurrently and drops what was overwritten meanwhile.
+     * Slots are relaxed atomic words (plain moves on common targets) fenced like a seqlock: a record the reader
+     * sees torn by a lapping writer is always one it drops.
+     */
+    class ThreadBuffer {
+    public:
+        static constexpr size_t Capacity = EMODBUS_TRACE_RING_SIZE;
+        static_assert((Capacity & (Capacity - 1)) == 0, "EMODBUS_TRACE_RING_SIZE must be a power of two");
+
+        explicit ThreadBuffer(const uint32_t thread) : thread_{thread} {
+        }
+
+        void push(const Record &record) {
+            const uint64_t head = head_.load(std::memory_order_relaxed);
+            // orders the previous head store before the overwrite, a reader seeing new words sees that head
+            std::atomic_thread_fence(std::memory_order_release);
+            const auto words = std::bit_cast<std::array<uint64_t, 2> >(record);
+            Slot &slot = slots_[head & (Capacity - 1)];
+            slot[0].store(words[0], std::memory_order_relaxed);
+            slot[1].store(words[1], std::memory_order_relaxed);
+            head_.store(head + 1, std::memory_order_release);
+        }
+
+        void copyTo(std::vector<ThreadRecord> &out) const;
+
+        void clear() {
+            tail_.store(head_.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+
+        uint32_t thread() const {
+            return thread_;
+        }
+
+    private:
+        uint32_t thread_;
+        std::atomic<uint64_t> head_{0};
+        /** records before it were cleared */
+        std::atomic<uint64_t> tail_{0};
+        using Slot = std::array<std::atomic<uint64_t>, 2>;
+        static_assert(sizeof(Slot) == sizeof(Record));
+        std::array<Slot, Capacity> slots_{};
+    };
+
+    /** @brief Ring of the calling thread, registered on first use. Rings outlive their threads. */
+    ThreadBuffer &threadBuffer();
+
+    inline uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /** @brief detail may be any enum or integer (SerialError, ValidationStatus, ...), it is stored truncated. */
+    template<typename Detail = uint16_t>
+    void emit(const Event event, const Phase phase, const uint8_t slave_ID, const uint8_t function_code,
+              const size_t length = 0, const Detail detail = {}) {
+        threadBuffer().push({
+            .timestamp_ns = now_ns(),
+            .event = event,
+            .phase = phase,
+            .slaveID = slave_ID,
+            .functionCode = function_code,
+            .length = static_cast<uint16_t>(length),
+            .detail = static_cast<uint16_t>(detail),
+        });
+    }
+
+    /** @brief Begin record now, end record when leaving the scope (exceptions included). */
+    class Scope {
+    public:
+        Scope(const Event event, const uint8_t slave_ID, const uint8_t function_code, const size_t length = 0)
+            : event_{event}, slaveID_{slave_ID}, functionCode_{function_code} {
+            emit(event_, Phase::Begin, slaveID_, functionCode_, length);
+        }
+
+        ~Scope() {
+            emit(event_, Phase::End, slaveID_, functionCode_, length_, detail_);
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        /** @brief Arguments of the end record. */
+        void result(const size_t length, const uint16_t detail) {
+            length_ = static_cast<uint16_t>(length);
+            detail_ = detail;
+        }
+
+    private:
+        Event event_;
+        uint8_t slaveID_;
+        uint8_t functionCode_;
+        uint16_t length_ = 0;
+        uint16_t detail_ = 0;
+    };
+
+    /** @brief Records of all threads ordered by time. */
+    std::vector<ThreadRecord> collect();
+
+    /** @brief Forgets everything recorded so far, in all threads. */
+    void clear();
+
+    /**
+     * Binary trace file: "EMBTRC01" | records as uint32 thread, uint64 timestamp, uint8 event, uint8 phase,
+     * uint8 slave ID, uint8 function code, uint16 length, uint16 detail (little endian, 20 bytes each).
+     */
+    bool save(const std::string &path, std::span<const ThreadRecord> records);
+
+    std::vector<ThreadRecord> load(const std::string &path);
+
+    /** @brief Chrome trace event format, loads in chrome://tracing and ui.perfetto.dev. */
+    std::string toChromeJson(std::span<const ThreadRecord> records);
+}
+
+#if EMODBUS_TRACE
+#define EMODBUS_TRACE_INSTANT(event, slave_ID, function_code, ...) \
+    ::eModbus::trace::emit(::eModbus::trace::Event::event, ::eModbus::trace::Phase::Instant, \
+                           static_cast<uint8_t>(slave_ID), static_cast<uint8_t>(function_code) __VA_OPT__(,) __VA_ARGS__)
+#define EMODBUS_TRACE_SCOPE(name, event, slave_ID, function_code, ...) \
+    ::eModbus::trace::Scope name(::eModbus::trace::Event::event, static_cast<uint8_t>(slave_ID), \
+                                 static_cast<uint8_t>(function_code) __VA_OPT__(,) __VA_ARGS__)
+#define EMODBUS_TRACE_RESULT(name, length, detail) name.result((length), static_cast<uint16_t>(detail))
+#else
+#define EMODBUS_TRACE_INSTANT(...) ((void)0)
+#define EMODBUS_TRACE_SCOPE(...) ((void)0)
+#define EMODBUS_TRACE_RESULT(...) ((void)0)
+#endif
+
+#endif //MODBUSTRACE_HPP
@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include <cstdint>
 #include <cmath>
 #include <span>      // For std::span (C++20)
@@ -6,6 +7,8 @@
 #include <cstring>   // For std::memcpy (pre-C++20 fallback)
 #include <stdexcept> // For exceptions like std::out_of_range
 #include <algorithm> // For std::fill
+#include <string>
+#include <vector>
 
 namespace eModbus {
     constexpr uint16_t MAX_MODBUS_REGISTERS = 125;
@@ -99,7 +102,7 @@ namespace eModbus {
     // Type: float (2 registers)
     template<>
     constexpr float convertFromRegisters<float>(const std::span<const uint16_t> registers) {
-        if (registers.size() < 4 ) throw std::out_of_range("Registers too small");
+        if (registers.size() < 2 ) throw std::out_of_range("Registers too small");
         uint32_t combined_u32 = registersToU32(registers);
         return MODBUS_BIT_CAST<float>(combined_u32);
     }
@@ -107,7 +110,7 @@ namespace eModbus {
     // Type: uint32_t (2 registers)
     template<>
     constexpr uint32_t convertFromRegisters<uint32_t>(const std::span<const uint16_t> registers) {
-        if (registers.size() < 4 ) throw std::out_of_range("Registers too small");
+        if (registers.size() < 2 ) throw std::out_of_range("Registers too small");
         return registersToU32(registers);
     }
 
@@ -185,7 +188,7 @@ namespace eModbus {
     // Type: float (2 registers)
     template<>
     constexpr void convertToRegisters<float>(std::span<uint16_t> registers, const float& source) {
-        if (registers.size() < 4 ) throw std::out_of_range("Registers too small");
+        if (registers.size() < 2 ) throw std::out_of_range("Registers too small");
         uint32_t combined = MODBUS_BIT_CAST<uint32_t>(source);
         u32ToRegisters(combined, registers);
     }
@@ -193,7 +196,7 @@ namespace eModbus {
     // Type: uint32_t (2 registers)
     template<>
     constexpr void convertToRegisters<uint32_t>(std::span<uint16_t> registers, const uint32_t& source) {
-        if (registers.size() < 4 ) throw std::out_of_range("Registers too small");
+        if (registers.size() < 2 ) throw std::out_of_range("Registers too small");
         u32ToRegisters(source, registers);
     }
 
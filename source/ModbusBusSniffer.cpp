@@ -0,0 +1,202 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include "ModbusBusSniffer.hpp"
+
+namespace {
+    /** shortest frame on the line: exception response */
+    constexpr size_t MIN_FRAME_SIZE = eModbus::Frame::RTU_RESPONSE_HEAD_SIZE + eModbus::Frame::CRC_SIZE;
+
+    eModbus::RegisterType registerTypeOf(const eModbus::Frame::FunctionCode function_code) {
+        switch (function_code) {
+            case eModbus::Frame::ReadCoils:
+            case eModbus::Frame::WriteSingleCoil:
+            case eModbus::Frame::WriteMultipleCoils:
+                return eModbus::RegisterType::Coil;
+            case eModbus::Frame::ReadDiscreteInputs:
+                return eModbus::RegisterType::DiscreteInput;
+            case eModbus::Frame::ReadInputRegisters:
+                return eModbus::RegisterType::AnalogInput;
+            default:
+                return eModbus::RegisterType::Holding;
+        }
+    }
+}
+
+size_t eModbus::BusSniffer::feed(std::span<const uint8_t> data) {
+    size_t decoded = 0;
+    while (!data.empty()) {
+        const size_t pushed = _ring.push(data);
+        data = data.subspan(pushed);
+        decoded += process();
+        if (pushed == 0) {
+            // the ring is full of something that never lines up, start over
+            _statistics.bytesSkipped += _ring.readable().size();
+            _ring.clear();
+        }
+    }
+    return decoded;
+}
+
+size_t eModbus::BusSniffer::process() {
+    size_t decoded = 0;
+    for (;;) {
+        const ByteRing::Segments data = _ring.readable();
+        if (data.size() < MIN_FRAME_SIZE)
+            break;
+        std::array<uint8_t, Frame::RTU_REQUEST_HEAD_SIZE> head{};
+        data.subspan(0, head.size()).copyTo(head);
+
+        bool need_more = false;
+        size_t corrupted_length = 0;
+        // a response is only expected right after a request, try it first
+        if (_pending) {
+            const size_t length = Frame::responseRTULength(head);
+            if (length > data.size()) {
+                need_more = true;
+            } else if (length != 0) {
+                const ByteRing::Segments adu = data.subspan(0, length);
+                if (Frame::validateRTU(adu) == Frame::ValidationStatus::OK) {
+                    handleResponse(adu);
+                    _ring.consume(length);
+                    ++decoded;
+                    continue;
+                }
+                if (head[0] == _request.slaveID() && (head[1] & 0x7F) == _request.functionCode())
+                    corrupted_length = length;
+            }
+        }
+        if (data.size() < Frame::RTU_REQUEST_HEAD_SIZE) {
+            need_more = true;
+        } else if (const size_t length = Frame::requestRTULength(head); length > data.size()) {
+            need_more = true;
+        } else if (length != 0) {
+            const ByteRing::Segments adu = data.subspan(0, length);
+            if (Frame::validateRTU(adu) == Frame::ValidationStatus::OK) {
+                handleRequest(adu);
+                _ring.consume(length);
+                ++decoded;
+                continue;
+            }
+        }
+        if (need_more)
+            break;
+        if (corrupted_length) {
+            // the awaited response, damaged on the line
+            ++_statistics.crcErrors;
+            _statistics.bytesSkipped += corrupted_length;
+            _pending = false;
+            _ring.consume(corrupted_length);
+            continue;
+        }
+        ++_statistics.bytesSkipped;
+        _ring.consume(1);
+    }
+    return decoded;
+}
+
+void eModbus::BusSniffer::handleRequest(const ByteRing::Segments &adu) {
+    ++_statistics.requests;
+    if (_pending)
+        ++_statistics.unmatched;
+    _request.setRawRtuData(adu, true);
+    // broadcasts are not answered
+    _pending = _request.slaveID() != 0;
+}
+
+void eModbus::BusSniffer::handleResponse(const ByteRing::Segments &adu) {
+    ++_statistics.responses;
+    _pending = false;
+    _response.setRawRtuData(adu, false);
+    if (_response.slaveID() != _request.slaveID()
+        || (static_cast<uint8_t>(_response.functionCode()) & 0x7F) != _request.functionCode()) {
+        ++_statistics.unmatched;
+        return;
+    }
+    if (_response.isException()) {
+        ++_statistics.exceptions;
+        return;
+    }
+
+    const uint8_t slave_ID = _request.slaveID();
+    const Frame::FunctionCode function_code = _request.functionCode();
+    const RegisterType register_type = registerTypeOf(function_code);
+    SlaveImage &image = _slaves[slave_ID];
+    RegisterImage &registers = image.registers;
+    switch (function_code) {
+        case Frame::ReadCoils:
+        case Frame::ReadDiscreteInputs:
+        case Frame::ReadHoldingRegisters:
+        case Frame::ReadInputRegisters: {
+            const uint16_t start = _request.startAddress();
+            const uint16_t quantity = _request.registerCount();
+            uint16_t index = 0;
+            _response.forEachRegisterValue([&](const uint16_t value) {
+                if (index < quantity)
+                    registers.set(register_type, static_cast<uint16_t>(start + index++), value);
+            });
+            updated(slave_ID, image, register_type, start, index);
+            break;
+        }
+        case Frame::WriteSingleCoil:
+        case Frame::WriteSingleRegister:
+            // the response echoes address and value
+            registers.set(register_type, _response.startAddress(), _response.registerCount());
+            updated(slave_ID, image, register_type, _response.startAddress(), 1);
+            break;
+        case Frame::WriteMultipleCoils: {
+            const uint16_t start = _request.startAddress();
+            const uint16_t quantity = _request.registerCount();
+            const std::span<uint8_t> bits = _request.registersData();
+            for (uint16_t i = 0; i < quantity && i / 8 < bits.size(); ++i)
+                registers.set(register_type, static_cast<uint16_t>(start + i),
+                              (bits[i / 8] >> (i % 8)) & 0x1 ? 0xFF00 : 0x0000);
+            updated(slave_ID, image, register_type, start, quantity);
+            break;
+        }
+        case Frame::WriteMultipleRegisters: {
+            const uint16_t start = _request.startAddress();
+            const uint16_t quantity = _request.registerCount();
+            uint16_t index = 0;
+            _request.forEachRegisterValue([&](const uint16_t value) {
+                if (index < quantity)
+                    registers.set(register_type, static_cast<uint16_t>(start + index++), value);
+            });
+            updated(slave_ID, image, register_type, start, index);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void eModbus::BusSniffer::updated(const uint8_t slave_ID, SlaveImage &image, const RegisterType register_type,
+                                  const uint16_t start_address, const uint16_t quantity) {
+    ++image.updates;
+    image.lastUpdate = std::chrono::steady_clock::now();
+    if (_onUpdate)
+        _onUpdate(slave_ID, register_type, start_address, quantity);
+}
+
+std::optional<uint16_t> eModbus::BusSniffer::get(const uint8_t slave_ID, const RegisterType register_type,
+                                                 const uint16_t address) const {
+    const SlaveImage *image = slave(slave_ID);
+    if (image == nullptr)
+        return std::nullopt;
+    return image->registers.get(register_type, address);
+}
+
+bool eModbus::BusSniffer::read(const uint8_t slave_ID, const RegisterType register_type,
+                               const uint16_t start_address, const std::span<uint16_t> values) const {
+    const SlaveImage *image = slave(slave_ID);
+    if (image == nullptr)
+        return false;
+    return image->registers.read(register_type, start_address, values);
+}
+
+void eModbus::BusSniffer::reset() {
+    _ring.clear();
+    _slaves.clear();
+    _statistics = {};
+    _pending = false;
+}
@@ -0,0 +1,264 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include "ModbusCaptureDevice.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ModbusTrace.hpp"
+
+namespace {
+    void putU16(uint8_t *destination, const uint16_t value) {
+        destination[0] = static_cast<uint8_t>(value);
+        destination[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    void putU64(uint8_t *destination, const uint64_t value) {
+        for (int i = 0; i < 8; ++i)
+            destination[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    uint16_t getU16(const uint8_t *source) {
+        return static_cast<uint16_t>(source[0] | source[1] << 8);
+    }
+
+    uint64_t getU64(const uint8_t *source) {
+        uint64_t result = 0;
+        for (int i = 7; i >= 0; --i)
+            result = result << 8 | source[i];
+        return result;
+    }
+}
+
+eModbus::capture::Reader::Reader(const std::string &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::runtime_error("Unable to open capture " + path);
+    struct stat info{};
+    ::fstat(fd, &info);
+    mapped_ = static_cast<size_t>(info.st_size);
+    if (mapped_ < HeaderSize) {
+        ::close(fd);
+        throw std::runtime_error("Capture too short " + path);
+    }
+    void *mapping = ::mmap(nullptr, mapped_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        throw std::runtime_error("Unable to map capture " + path);
+    data_ = static_cast<const uint8_t *>(mapping);
+    ::madvise(mapping, mapped_, MADV_SEQUENTIAL);
+
+    if (std::memcmp(data_, Magic, sizeof(Magic)) != 0) {
+        ::munmap(mapping, mapped_);
+        throw std::runtime_error("Not an eModbus capture " + path);
+    }
+    used_ = std::min<size_t>(getU64(data_ + sizeof(Magic)), mapped_);
+}
+
+eModbus::capture::Reader::~Reader() {
+    ::munmap(const_cast<uint8_t *>(data_), mapped_);
+}
+
+std::optional<eModbus::capture::Record> eModbus::capture::Reader::parse(const size_t position,
+                                                                        size_t *next_position) const {
+    if (position + RecordHeaderSize > used_)
+        return std::nullopt;
+    const uint8_t *header = data_ + position;
+    const uint16_t length = getU16(header + 10);
+    if (position + RecordHeaderSize + length > used_)
+        return std::nullopt;
+    if (next_position)
+        *next_position = position + RecordHeaderSize + length;
+    return Record{
+        .timestamp_ns = getU64(header),
+        .direction = static_cast<Direction>(header[8]),
+        .status = static_cast<SerialError>(header[9]),
+        .data = std::span(header + RecordHeaderSize, length),
+    };
+}
+
+std::optional<eModbus::capture::Record> eModbus::capture::Reader::next() {
+    return parse(position_, &position_);
+}
+
+std::optional<eModbus::capture::Record> eModbus::capture::Reader::peek() const {
+    return parse(position_, nullptr);
+}
+
+eModbus::RecordingStreamDevice::RecordingStreamDevice(IStreamDevice &device, const std::string &path,
+                                                      const size_t initial_capacity)
+    : _device(device), _start(std::chrono::steady_clock::now()) {
+    _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (_fd < 0)
+        throw std::runtime_error("Unable to create capture " + path);
+    if (!grow(std::max(initial_capacity, capture::HeaderSize))) {
+        ::close(_fd);
+        throw std::runtime_error("Unable to map capture " + path);
+    }
+    std::memcpy(_data, capture::Magic, sizeof(capture::Magic));
+    putU64(_data + sizeof(capture::Magic), _used);
+    appendBaudrate(_device.baudrate());
+}
+
+eModbus::RecordingStreamDevice::~RecordingStreamDevice() {
+    ::munmap(_data, _capacity);
+    if (::ftruncate(_fd, static_cast<off_t>(_used)) != 0) {
+        // the used size in the header still tells the reader where the data ends
+    }
+    ::close(_fd);
+}
+
+bool eModbus::RecordingStreamDevice::grow(const size_t required) {
+    size_t capacity = std::max<size_t>(_capacity, 4096);
+    while (capacity < required)
+        capacity *= 2;
+    if (capacity == _capacity)
+        return true;
+    if (::ftruncate(_fd, static_cast<off_t>(capacity)) != 0)
+        return false;
+    void *mapping = _data == nullptr
+                        ? ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0)
+                        : ::mremap(_data, _capacity, capacity, MREMAP_MAYMOVE);
+    if (mapping == MAP_FAILED)
+        return false;
+    _data = static_cast<uint8_t *>(mapping);
+    _capacity = capacity;
+    return true;
+}
+
+void eModbus::RecordingStreamDevice::append(const capture::Direction direction, const SerialError status,
+                                            std::span<const uint8_t> data) {
+    data = data.first(std::min<size_t>(data.size(), UINT16_MAX));
+    const size_t record_size = capture::RecordHeaderSize + data.size();
+    if (_used + record_size > _capacity && !grow(_used + record_size)) {
+        ++_dropped;
+        return;
+    }
+    const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - _start);
+
+    uint8_t *record = _data + _used;
+    putU64(record, static_cast<uint64_t>(timestamp.count()));
+    record[8] = static_cast<uint8_t>(direction);
+    record[9] = static_cast<uint8_t>(status);
+    putU16(record + 10, static_cast<uint16_t>(data.size()));
+    std::memcpy(record + capture::RecordHeaderSize, data.data(), data.size());
+    _used += record_size;
+    putU64(_data + sizeof(capture::Magic), _used);
+}
+
+void eModbus::RecordingStreamDevice::baudrate(const uint32_t baudrate) {
+    const bool changed = baudrate != _device.baudrate();
+    _device.baudrate(baudrate);
+    if (changed)
+        appendBaudrate(baudrate);
+}
+
+void eModbus::RecordingStreamDevice::appendBaudrate(const uint32_t baudrate) {
+    uint8_t data[sizeof(baudrate)];
+    for (size_t i = 0; i < sizeof(baudrate); ++i)
+        data[i] = static_cast<uint8_t>(baudrate >> (8 * i));
+    append(capture::Direction::Baudrate, SerialError::SUCCESS, data);
+}
+
+SerialError eModbus::RecordingStreamDevice::read(const std::span<uint8_t> buffer, const uint32_t timeout_ms,
+                                                 size_t *bytes_read_out) {
+    size_t read_count = 0;
+    const SerialError err = _device.read(buffer, timeout_ms, &read_count);
+    append(capture::Direction::Read, err, buffer.first(std::min(read_count, buffer.size())));
+    if (bytes_read_out)
+        *bytes_read_out = read_count;
+    return err;
+}
+
+SerialError eModbus::RecordingStreamDevice::write(const std::span<const uint8_t> buffer, const uint32_t timeout_ms,
+                                                  size_t *bytes_written_out) {
+    const SerialError err = _device.write(buffer, timeout_ms, bytes_written_out);
+    append(capture::Direction::Write, err, buffer);
+    return err;
+}
+
+eModbus::ReplayStreamDevice::ReplayStreamDevice(const std::string &path, const double speed)
+    : _reader(path), _speed(speed), _start(std::chrono::steady_clock::now()) {
+    peekTransfer();
+}
+
+void eModbus::ReplayStreamDevice::rewind() {
+    _reader.rewind();
+    _firstTimestamp_ns.reset();
+    peekTransfer();
+}
+
+std::optional<eModbus::capture::Record> eModbus::ReplayStreamDevice::peekTransfer() {
+    std::optional<capture::Record> record = _reader.peek();
+    while (record && record->direction == capture::Direction::Baudrate) {
+        if (record->data.size() == sizeof(_baudrate)) {
+            _baudrate = 0;
+            for (size_t i = sizeof(_baudrate); i-- > 0;)
+                _baudrate = _baudrate << 8 | record->data[i];
+        }
+        _reader.next();
+        record = _reader.peek();
+    }
+    return record;
+}
+
+void eModbus::ReplayStreamDevice::waitFor(const uint64_t timestamp_ns) {
+    if (!_firstTimestamp_ns) {
+        _firstTimestamp_ns = timestamp_ns;
+        _start = std::chrono::steady_clock::now();
+    }
+    if (_speed <= 0.0)
+        return;
+    const auto offset = std::chrono::nanoseconds(
+        static_cast<int64_t>(static_cast<double>(timestamp_ns - *_firstTimestamp_ns) / _speed));
+    std::this_thread::sleep_until(_start + offset);
+}
+
+SerialError eModbus::ReplayStreamDevice::read(const std::span<uint8_t> buffer, uint32_t, size_t *bytes_read_out) {
+    if (bytes_read_out)
+        *bytes_read_out = 0;
+    const std::optional<capture::Record> record = peekTransfer();
+    if (!record || record->direction != capture::Direction::Read)
+        return SerialError::TIMEOUT;
+    _reader.next();
+    waitFor(record->timestamp_ns);
+
+    const size_t count = std::min(record->data.size(), buffer.size());
+    std::memcpy(buffer.data(), record->data.data(), count);
+    EMODBUS_TRACE_INSTANT(DeviceRead, 0, 0, count, record->status);
+    if (bytes_read_out)
+        *bytes_read_out = count;
+    return record->status;
+}
+
+SerialError eModbus::ReplayStreamDevice::write(const std::span<const uint8_t> buffer, uint32_t,
+                                               size_t *bytes_written_out) {
+    if (bytes_written_out)
+        *bytes_written_out = 0;
+    // reads the master skipped (e.g. it gave up earlier than in the recording) are dropped
+    std::optional<capture::Record> record = peekTransfer();
+    while (record && record->direction != capture::Direction::Write) {
+        _reader.next();
+        record = peekTransfer();
+    }
+    if (!record)
+        return SerialError::INTERNAL_ERROR;
+    _reader.next();
+    waitFor(record->timestamp_ns);
+
+    if (!std::ranges::equal(buffer, record->data))
+        ++_mismatched;
+    EMODBUS_TRACE_INSTANT(DeviceWrite, 0, 0, buffer.size(), record->status);
+    if (bytes_written_out)
+        *bytes_written_out = buffer.size();
+    return record->status;
+}
@@ -3,106 +3,243 @@
 //
 #include "ModbusMasterBase.hpp"
 
+#include <algorithm>
 #include <map>
 #include <chrono>
 
 #include "ModbusRegisterBuffer.hpp"
 using namespace std::chrono_literals;
-eModbus::MasterBase::MasterBase(IStreamDevice &serial_device):_streamDevice(serial_device) {
+
+namespace {
+    /** IStreamDevice timeouts are in milliseconds: round up, never 0 (which would mean "don't wait"). */
+    uint32_t toTimeoutMs(const uint32_t time_us) {
+        return std::max<uint32_t>(1, (time_us + 999) / 1000);
+    }
 }
 
+eModbus::MasterBase::MasterBase(IStreamDevice &serial_device, std::pmr::memory_resource *resource)
+    : _streamDevice(serial_device), devicesBaudratesMap(resource) {
+}
 
-eModbus::MasterBase eModbus::MasterBase::TCP(IStreamDevice &serial_device) {
-    eModbus::MasterBase result(serial_device);
-    result.isTCP = true;
+
+eModbus::MasterBase eModbus::MasterBase::TCP(IStreamDevice &serial_device, std::pmr::memory_resource *resource) {
+    eModbus::MasterBase result(serial_device, resource);
+    result.transport = Transport::TCP;
     return result;
 }
 
-eModbus::MasterBase eModbus::MasterBase::RTU(IStreamDevice &serial_device) {
-    eModbus::MasterBase result(serial_device);
-    result.isTCP = false;
+eModbus::MasterBase eModbus::MasterBase::RTU(IStreamDevice &serial_device, std::pmr::memory_resource *resource) {
+    eModbus::MasterBase result(serial_device, resource);
+    result.transport = Transport::RTU;
     return result;
 }
 
-std::vector<uint16_t> eModbus::MasterBase::read(const uint8_t slave_ID, const RegisterType register_type,
-    const uint16_t start_address, const uint8_t quantity) {
-    eModbus::Frame frame = eModbus::Frame::build(
+eModbus::MasterBase eModbus::MasterBase::RTUoverTCP(IStreamDevice &serial_device,
+                                                    std::pmr::memory_resource *resource) {
+    eModbus::MasterBase result(serial_device, resource);
+    result.transport = Transport::RTUoverTCP;
+    return result;
+}
+
+eModbus::Frame &eModbus::MasterBase::transact(const uint8_t slave_ID, const bool is_read,
+    const RegisterType register_type, const uint16_t start_address, const uint16_t quantity,
+    const std::span<uint16_t> values) {
+    _request.rebuild(
         true,
         slave_ID,
-        getFunctionCode(true,register_type),
+        getFunctionCode(is_read,register_type),
         start_address,
-        quantity);
-    // ModbusFrame receiveFrame{};
-    sendReceiveFrame(frame,frame);
-    if (frame.isException())
-        throw ModbusException(frame.exceptionCode());
-    return frame.registersValues();
+        quantity,values);
+    sendReceiveFrame(_request,_response);
+    if (_response.isException())
+        throw ModbusException(_response.exceptionCode());
+    return _response;
+}
+
+std::vector<uint16_t> eModbus::MasterBase::read(const uint8_t slave_ID, const RegisterType register_type,
+    const uint16_t start_address, const uint8_t quantity) {
+    return transact(slave_ID, true, register_type, start_address, quantity).registersValues();
+}
+
+std::pmr::vector<uint16_t> eModbus::MasterBase::read(const uint8_t slave_ID, const RegisterType register_type,
+    const uint16_t start_address, const uint8_t quantity, std::pmr::memory_resource *resource) {
+    return transact(slave_ID, true, register_type, start_address, quantity).registersValues(resource);
 }
 
 void eModbus::MasterBase::read(const uint8_t slave_ID, const eModbus::RegisterBufferView &outBuffer) {
-    std::ranges::copy(read(
-                            slave_ID,
-                            outBuffer.registerType(),
-                            outBuffer.startAddress(),
-                            outBuffer.buffer().size()),
-                    outBuffer.buffer().begin());
+    transact(slave_ID, true, outBuffer.registerType(), outBuffer.startAddress(),
+             static_cast<uint16_t>(outBuffer.buffer().size())).copyRegistersValues(outBuffer.buffer());
 }
 
 
 void eModbus::MasterBase::write(uint8_t slave_ID, RegisterType register_type, uint16_t start_address,
     std::span<uint16_t> values) {
-    eModbus::Frame frame = eModbus::Frame::build(
-        true,
-        slave_ID,
-        getFunctionCode(false,register_type),
-        start_address,
-        values.size(),values);
-    // eModbus::Frame receiveFrame{};
-    sendReceiveFrame(frame,frame);
-    if (frame.isException())
-        throw ModbusException(frame.exceptionCode());
+    transact(slave_ID, false, register_type, start_address, static_cast<uint16_t>(values.size()), values);
 }
 
 void eModbus::MasterBase::sendFrame(eModbus::Frame &send_frame, const uint16_t timeout_ms) const {
-    const SerialError err = _streamDevice.write(
-        isTCP ? send_frame.tcpFrame() : send_frame.rtuFrame(), timeout_ms);
+    writeRequest(send_frame, encode(send_frame), timeout_ms);
+}
+
+void eModbus::MasterBase::writeRequest(const eModbus::Frame &send_frame, const std::span<const uint8_t> data,
+                                       const uint32_t timeout_ms) const {
+    EMODBUS_TRACE_SCOPE(trace, Send, send_frame.slaveID(), send_frame.functionCode(), data.size());
+    const SerialError err = _streamDevice.write(data, timeout_ms);
+    EMODBUS_TRACE_RESULT(trace, data.size(), err);
     if (err != SerialError::SUCCESS)
         throw StreamDeviceFailure(err);
 }
 
 void eModbus::MasterBase::receiveFrame(eModbus::Frame &receive_frame,const uint16_t timeout_ms) const {
     receive_frame.isRequest(false);
-    const SerialError err = _streamDevice.read(isTCP ? receive_frame.buffer() : receive_frame.rtuBuffer(),
-                                         timeout_ms);
+    EMODBUS_TRACE_SCOPE(trace, Receive, 0, 0);
+    size_t received = 0;
+    const SerialError err = readResponse(receive_frame, timeout_ms, &received);
+    EMODBUS_TRACE_RESULT(trace, received, err);
     if (err != SerialError::SUCCESS) {
         throw StreamDeviceFailure(err);
     }
 
 }
 
+SerialError eModbus::MasterBase::readResponse(eModbus::Frame &receive_frame, const uint32_t timeout_ms,
+                                              size_t *bytes_read_out) const {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    const std::span<uint8_t> buffer = usesMBAP() ? receive_frame.buffer() : receive_frame.rtuBuffer();
+    const size_t head_size = usesMBAP() ? eModbus::Frame::MBAP_HEADER_SIZE : eModbus::Frame::RTU_RESPONSE_HEAD_SIZE;
+    size_t received = 0;
+    SerialError err = _streamDevice.read(buffer.first(head_size), timeout_ms, &received);
+    if (err == SerialError::SUCCESS) {
+        const std::span<const uint8_t> head = buffer.first(head_size);
+        const size_t length = usesMBAP()
+                                  ? eModbus::Frame::tcpADULength(head)
+                                  : eModbus::Frame::responseRTULength(head);
+        // unknown length: take whatever comes until the buffer is full or the device gives up
+        const size_t end = length >= head_size ? std::min(length, buffer.size()) : buffer.size();
+        if (end > head_size) {
+            const auto left = std::chrono::duration_cast<std::chrono::microseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            size_t rest = 0;
+            err = _streamDevice.read(buffer.subspan(head_size, end - head_size),
+                                     toTimeoutMs(static_cast<uint32_t>(std::max<int64_t>(left, 0))), &rest);
+            received += rest;
+        }
+    }
+    if (bytes_read_out)
+        *bytes_read_out = received;
+    return err;
+}
+
 void eModbus::MasterBase::sendReceiveFrame(eModbus::Frame &send_frame, eModbus::Frame &receive_frame) {
+    if (&send_frame == &receive_frame) {
+        // the encoded request lives in send_frame: a response received over it would be what the retries resend,
+        // so receive into the other internal frame and hand the response over at the end
+        eModbus::Frame &aside = &receive_frame == &_response ? _request : _response;
+        sendReceiveEncoded(send_frame, encode(send_frame), aside);
+        receive_frame = aside;
+        return;
+    }
+    // encoded once, retries send the same bytes again
+    sendReceiveEncoded(send_frame, encode(send_frame), receive_frame);
+}
 
+void eModbus::MasterBase::sendReceiveEncoded(const eModbus::Frame &send_frame, const std::span<const uint8_t> request,
+                                             eModbus::Frame &receive_frame) {
     uint16_t slave_ID = send_frame.slaveID();
     uint32_t baud = 0;
 
-    if (!devicesBaudratesMap.contains(slave_ID)) {
+    if (!isSerialLine()) {
+        // the line behind a socket is not ours to switch, its baud rate (if the device knows it) only scales timeouts
+        baud = _streamDevice.baudrate();
+    } else if (!devicesBaudratesMap.contains(slave_ID)) {
         baud = detectBaud(slave_ID, baudrates);
         if (baud == 0)
             throw StreamDeviceFailure(SerialError::TIMEOUT);;
+        _streamDevice.baudrate(baud);
     } else {
         baud = devicesBaudratesMap[slave_ID];
+        _streamDevice.baudrate(baud);
     }
-    _streamDevice.baudrate(baud);
-    sendFrame(send_frame, send_frame.calculateTransmissionTimeMs(baud) * 2);
-    receiveFrame(receive_frame, getResponseTimeout(send_frame, devicesBaudratesMap[slave_ID]));
+    EMODBUS_TRACE_SCOPE(trace, Transaction, slave_ID, send_frame.functionCode());
+    const bool may_retry = retryPolicy.allows(send_frame.functionCode());
+    for (uint8_t attempt = 1;; ++attempt) {
+        uint8_t reason = 0;
+        try {
+            sendReceiveAttempt(send_frame, request, receive_frame, baud);
+            if (!receive_frame.isException())
+                return;
+            reason = RetryPolicy::reasonFor(receive_frame.exceptionCode());
+            if (!may_retry || !retryPolicy.shouldRetry(attempt, reason))
+                return;
+        } catch (const InvalidFrame &e) {
+            reason = e._validation_status == eModbus::Frame::ValidationStatus::InvalidCRC
+                         ? RetryPolicy::CrcError
+                         : RetryPolicy::InvalidFrame;
+            if (!may_retry || !retryPolicy.shouldRetry(attempt, reason))
+                throw;
+        } catch (const StreamDeviceFailure &e) {
+            reason = e._device_error == SerialError::TIMEOUT ? RetryPolicy::Timeout : 0;
+            if (!may_retry || !retryPolicy.shouldRetry(attempt, reason))
+                throw;
+        }
+        MasterTransactionProbe(metricsSink(), slave_ID, send_frame.functionCode()).count(Metrics::Counter::Retries);
+        if (const uint32_t backoff = retryPolicy.backoff(attempt, _retryRandom()))
+            _streamDevice.delay(backoff);
+    }
+}
 
-    eModbus::Frame::ValidationStatus validation = receive_frame.validateRTU();
-    if (validation != eModbus::Frame::ValidationStatus::OK)
+void eModbus::MasterBase::sendReceiveAttempt(const eModbus::Frame &send_frame, const std::span<const uint8_t> request,
+                                             eModbus::Frame &receive_frame, const uint32_t baud) {
+    MasterTransactionProbe probe(metricsSink(), send_frame.slaveID(), send_frame.functionCode());
+    const uint32_t response_wire_us = send_frame.responseTransmissionTime_us(baud);
+    waitInterFrameDelay(baud);
+    writeRequest(send_frame, request, getSendTimeout(send_frame, baud));
+    probe.sent(send_frame.transmissionTime_us(baud));
+    try {
+        receiveFrame(receive_frame, getResponseTimeout(send_frame, baud));
+        markLineIdle();
+    } catch (const StreamDeviceFailure &e) {
+        markLineIdle();
+        probe.failed(e._device_error == SerialError::TIMEOUT
+                         ? Metrics::Counter::Timeouts
+                         : Metrics::Counter::StreamFailures);
+        throw;
+    }
+
+    eModbus::Frame::ValidationStatus validation = validateResponse(receive_frame);
+    if (validation != eModbus::Frame::ValidationStatus::OK) {
+        probe.failed(validation == eModbus::Frame::ValidationStatus::InvalidCRC
+                         ? Metrics::Counter::CrcErrors
+                         : Metrics::Counter::InvalidFrames);
         throw InvalidFrame(validation);
+    }
+    probe.received(response_wire_us);
+    if (receive_frame.isException())
+        probe.count(Metrics::Counter::Exceptions);
+}
+
+uint32_t eModbus::MasterBase::getSendTimeout(const eModbus::Frame &send_frame, const uint32_t baud) const {
+    return toTimeoutMs(send_frame.transmissionTime_us(baud) + eModbus::Frame::t35_us(baud));
+}
+
+uint32_t eModbus::MasterBase::getResponseTimeout(const eModbus::Frame &send_frame, const unsigned long baud) const {
+    const auto baud_rate = static_cast<uint32_t>(baud);
+    return toTimeoutMs(send_frame.responseTransmissionTime_us(baud_rate) + eModbus::Frame::t35_us(baud_rate)
+                       + deviceResponseTime_us);
+}
+
+void eModbus::MasterBase::waitInterFrameDelay(const uint32_t baud) const {
+    if (!isSerialLine() || _lineIdleSince == std::chrono::steady_clock::time_point{})
+        return;
+    const auto ready_at = _lineIdleSince + std::chrono::microseconds(eModbus::Frame::t35_us(baud));
+    const auto now = std::chrono::steady_clock::now();
+    if (now < ready_at)
+        _streamDevice.interFrameDelay(static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(ready_at - now).count()));
 }
 
-uint32_t eModbus::MasterBase::getResponseTimeout(eModbus::Frame send_frame, const unsigned long baud) const {
-    return send_frame.calculateResponseTransmissionTimeMs(baud) + deviceResponseTime_ms;
+void eModbus::MasterBase::markLineIdle() {
+    _lineIdleSince = std::chrono::steady_clock::now();
 }
 
 uint32_t eModbus::MasterBase::detectBaud(const uint8_t slave_ID, std::span<const uint32_t> baudrates) {
@@ -111,16 +248,18 @@ uint32_t eModbus::MasterBase::detectBaud(const uint8_t slave_ID, std::span<const
     eModbus::Frame receive_frame;
     uint32_t working_baud = 0;
     uint32_t originalBaud = _streamDevice.baudrate();
-    if (originalBaud != IStreamDevice::InvalidBaudrate) {
+    if (isSerialLine() && originalBaud != IStreamDevice::InvalidBaudrate) {
         for (const auto baud : baudrates) {
             _streamDevice.baudrate(baud); // Set the new baud rate for testing
 
-            SerialError err = _streamDevice.write(send_frame.rtuFrame(), send_frame.calculateTransmissionTimeMs(baud)*2);
+            waitInterFrameDelay(baud);
+            SerialError err = _streamDevice.write(encode(send_frame), getSendTimeout(send_frame, baud));
             if (err != SerialError::SUCCESS) {
                 break;
             }
 
-            err = _streamDevice.read(receive_frame.rtuBuffer(), getResponseTimeout(send_frame, baud));
+            err = readResponse(receive_frame, getResponseTimeout(send_frame, baud));
+            markLineIdle();
             if (err == SerialError::TIMEOUT) {
                 continue;
             }
@@ -128,7 +267,7 @@ uint32_t eModbus::MasterBase::detectBaud(const uint8_t slave_ID, std::span<const
                 break;
             }
 
-            if (receive_frame.validateRTU() == eModbus::Frame::ValidationStatus::OK) {
+            if (validateResponse(receive_frame) == eModbus::Frame::ValidationStatus::OK) {
                 // Success! We found the working baud rate.
                 working_baud = baud; // Return the working baud and leave it set.
                 break;
@@ -137,15 +276,15 @@ uint32_t eModbus::MasterBase::detectBaud(const uint8_t slave_ID, std::span<const
         _streamDevice.baudrate(originalBaud);
     }else {
         originalBaud = 9600;
-        if (_streamDevice.write(send_frame.rtuFrame(), send_frame.calculateTransmissionTimeMs(originalBaud)*2) != SerialError::SUCCESS) {
+        if (_streamDevice.write(encode(send_frame), getSendTimeout(send_frame, originalBaud)) != SerialError::SUCCESS) {
             return IStreamDevice::InvalidBaudrate;
         }
 
-        if (_streamDevice.read(receive_frame.rtuBuffer(), getResponseTimeout(send_frame, originalBaud)) != SerialError::SUCCESS) {
+        if (readResponse(receive_frame, getResponseTimeout(send_frame, originalBaud)) != SerialError::SUCCESS) {
             return IStreamDevice::InvalidBaudrate;
         }
 
-        if (receive_frame.validateRTU() == eModbus::Frame::ValidationStatus::OK) {
+        if (validateResponse(receive_frame) == eModbus::Frame::ValidationStatus::OK) {
             working_baud = baudrates.empty() ? 1 : baudrates[0];
         }
     }
@@ -159,7 +298,7 @@ uint32_t eModbus::MasterBase::detectBaud(const uint8_t slave_ID, std::span<const
 }
 
 
-std::map<uint8_t, uint32_t> eModbus::MasterBase::scanForDevices(std::span<uint32_t> baudrates, uint16_t timeoutMs) {
+eModbus::MasterBase::BaudrateMap eModbus::MasterBase::scanForDevices(std::span<uint32_t> baudrates, uint16_t timeoutMs) {
     constexpr int MODBUS_MIN_ADDRESS = 1;
     constexpr int MODBUS_MAX_ADDRESS = 247;
 
@@ -0,0 +1,409 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include "ModbusMasterPool.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include "ModbusMasterBase.hpp"
+#include "ModbusTrace.hpp"
+
+namespace {
+    constexpr size_t MAX_EPOLL_EVENTS = 64;
+    constexpr size_t MAX_TCP_ADU_SIZE = 260;
+    constexpr size_t MAX_IOVECS = 64;
+}
+
+eModbus::MasterPool::MasterPool() : _epollFd(::epoll_create1(EPOLL_CLOEXEC)) {
+    if (_epollFd < 0)
+        throw std::runtime_error("epoll_create1 failed");
+}
+
+eModbus::MasterPool::~MasterPool() {
+    for (const Connection &connection: _connections) {
+        if (connection.fd >= 0)
+            ::close(connection.fd);
+    }
+    ::close(_epollFd);
+}
+
+eModbus::MasterPool::ConnectionID eModbus::MasterPool::addEndpoint(const Endpoint &endpoint, const size_t window) {
+    if (const auto it = _endpoints.find(endpoint); it != _endpoints.end())
+        return it->second;
+    if (window == 0)
+        throw std::invalid_argument("Pipelining window must be at least 1");
+
+    const auto connection_id = static_cast<ConnectionID>(_connections.size());
+    Connection &connection = _connections.emplace_back();
+    connection.endpoint = endpoint;
+    connection.window = window;
+    connection.inFlight.reserve(window);
+    _endpoints.emplace(endpoint, connection_id);
+    return connection_id;
+}
+
+eModbus::MasterPool::ConnectionID eModbus::MasterPool::connection(const Endpoint &endpoint) const {
+    return _endpoints.at(endpoint);
+}
+
+void eModbus::MasterPool::submit(const ConnectionID connection_id, const Frame &request, Callback callback,
+                                 const uint32_t timeout_ms) {
+    Connection &connection = _connections.at(connection_id);
+    Transaction &transaction = connection.queued.emplace_back(Transaction{
+        .frame = request,
+        .callback = std::move(callback),
+        .timeout_ms = timeout_ms,
+        .deadline = Clock::now() + std::chrono::milliseconds(timeout_ms),
+    });
+    transaction.frame.isRequest(true);
+}
+
+void eModbus::MasterPool::read(const ConnectionID connection_id, const uint8_t unit_ID,
+                               const RegisterType register_type, const uint16_t start_address,
+                               const uint16_t quantity, Callback callback, const uint32_t timeout_ms) {
+    submit(connection_id,
+           Frame::build(true, unit_ID, MasterBase::getFunctionCode(true, register_type), start_address, quantity),
+           std::move(callback), timeout_ms);
+}
+
+size_t eModbus::MasterPool::pending() const {
+    size_t result = 0;
+    for (const Connection &connection: _connections)
+        result += connection.queued.size() + connection.inFlight.size();
+    return result;
+}
+
+void eModbus::MasterPool::runUntilIdle(const uint32_t poll_timeout_ms) {
+    while (pending() != 0)
+        poll(poll_timeout_ms);
+}
+
+size_t eModbus::MasterPool::poll(const uint32_t timeout_ms) {
+    size_t dispatched = 0;
+    Clock::time_point now = Clock::now();
+
+    for (ConnectionID id = 0; id < _connections.size(); ++id) {
+        Connection &connection = _connections[id];
+        if (connection.state == State::Disconnected && !connection.queued.empty() && now >= connection.reconnectAt
+            && !connect(id, now))
+            disconnect(id, SerialError::INTERNAL_ERROR, dispatched);
+        if (connection.state == State::Connected) {
+            fillWindow(connection);
+            if (!flushTx(id))
+                disconnect(id, SerialError::INTERNAL_ERROR, dispatched);
+        }
+    }
+
+    const auto wait = std::chrono::ceil<std::chrono::milliseconds>(
+        nearestDeadline(now + std::chrono::milliseconds(timeout_ms)) - now);
+    std::array<epoll_event, MAX_EPOLL_EVENTS> events{};
+    const int ready = ::epoll_wait(_epollFd, events.data(), static_cast<int>(events.size()),
+                                   static_cast<int>(std::max<int64_t>(wait.count(), 0)));
+
+    for (int i = 0; i < ready; ++i) {
+        const auto id = static_cast<ConnectionID>(events[i].data.u32);
+        Connection &connection = _connections[id];
+        const uint32_t flags = events[i].events;
+
+        if (connection.state == State::Connecting && (flags & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            ::getsockopt(connection.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+            if (error != 0) {
+                disconnect(id, SerialError::INTERNAL_ERROR, dispatched);
+                continue;
+            }
+            connection.state = State::Connected;
+            fillWindow(connection);
+        }
+        if (flags & EPOLLIN) {
+            if (!receive(id, dispatched))
+                continue;
+        }
+        if (flags & (EPOLLERR | EPOLLHUP)) {
+            disconnect(id, SerialError::INTERNAL_ERROR, dispatched);
+            continue;
+        }
+        if (connection.state == State::Connected) {
+            fillWindow(connection);
+            if (!flushTx(id))
+                disconnect(id, SerialError::INTERNAL_ERROR, dispatched);
+        }
+    }
+
+    now = Clock::now();
+    for (ConnectionID id = 0; id < _connections.size(); ++id) {
+        if (!expire(_connections[id], now, dispatched))
+            disconnect(id, SerialError::TIMEOUT, dispatched);
+    }
+
+    return dispatched;
+}
+
+bool eModbus::MasterPool::connect(const ConnectionID connection_id, const Clock::time_point now) {
+    Connection &connection = _connections[connection_id];
+    connection.reconnectAt = now + std::chrono::milliseconds(reconnectDelay_ms);
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV;
+    addrinfo *addresses = nullptr;
+    const std::string port = std::to_string(connection.endpoint.port);
+    if (::getaddrinfo(connection.endpoint.host.c_str(), port.c_str(), &hints, &addresses) != 0)
+        return false;
+
+    for (const addrinfo *address = addresses; address != nullptr; address = address->ai_next) {
+        const int fd = ::socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                                address->ai_protocol);
+        if (fd < 0)
+            continue;
+        constexpr int enable = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        if (::connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+            connection.state = State::Connected;
+        } else if (errno == EINPROGRESS) {
+            connection.state = State::Connecting;
+            connection.connectDeadline = now + std::chrono::milliseconds(connectTimeout_ms);
+        } else {
+            ::close(fd);
+            continue;
+        }
+
+        connection.fd = fd;
+        connection.rxSize = 0;
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT;
+        event.data.u32 = connection_id;
+        ::epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event);
+        connection.wantWrite = true;
+        break;
+    }
+    ::freeaddrinfo(addresses);
+    return connection.fd >= 0;
+}
+
+void eModbus::MasterPool::disconnect(const ConnectionID connection_id, const SerialError reason, size_t &dispatched) {
+    Connection &connection = _connections[connection_id];
+    if (connection.fd >= 0) {
+        ::epoll_ctl(_epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+        ::close(connection.fd);
+    }
+    connection.fd = -1;
+    connection.state = State::Disconnected;
+    connection.rxSize = 0;
+
+    // Fail everything, the caller decides what is worth resubmitting after reconnectDelay_ms
+    std::vector<Transaction> failed;
+    failed.swap(connection.inFlight);
+    connection.inFlight.reserve(connection.window);
+    std::ranges::move(connection.queued, std::back_inserter(failed));
+    connection.queued.clear();
+    for (Transaction &transaction: failed) {
+        transaction.callback(reason, transaction.frame);
+        ++dispatched;
+    }
+}
+
+void eModbus::MasterPool::updateInterest(const ConnectionID connection_id, const bool want_write) {
+    Connection &connection = _connections[connection_id];
+    if (connection.wantWrite == want_write || connection.fd < 0)
+        return;
+    epoll_event event{};
+    uint32_t events = EPOLLIN;
+    if (want_write)
+        events |= EPOLLOUT;
+    event.events = events;
+    event.data.u32 = connection_id;
+    ::epoll_ctl(_epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+    connection.wantWrite = want_write;
+}
+
+void eModbus::MasterPool::fillWindow(Connection &connection) {
+    while (!connection.queued.empty() && connection.inFlight.size() < connection.window) {
+        Transaction &transaction = connection.inFlight.emplace_back(std::move(connection.queued.front()));
+        connection.queued.pop_front();
+
+        transaction.frame.transactionID(connection.nextTransactionID++);
+        transaction.frame.protocolID(0);
+        transaction.unsent = static_cast<uint16_t>(transaction.frame.tcpFrame().size());
+    }
+}
+
+bool eModbus::MasterPool::flushTx(const ConnectionID connection_id) {
+    Connection &connection = _connections[connection_id];
+    while (true) {
+        // in-flight transactions keep send order, so unsent bytes are always a suffix of the window
+        std::array<iovec, MAX_IOVECS> iov{};
+        size_t iov_count = 0;
+        for (Transaction &transaction: connection.inFlight) {
+            if (transaction.unsent == 0)
+                continue;
+            if (iov_count == iov.size())
+                break;
+            const std::span<const uint8_t> adu = transaction.frame.tcpFrame();
+            const std::span<const uint8_t> remaining = adu.last(transaction.unsent);
+            iov[iov_count++] = {const_cast<uint8_t *>(remaining.data()), remaining.size()};
+        }
+        if (iov_count == 0)
+            break;
+
+        msghdr message{};
+        message.msg_iov = iov.data();
+        message.msg_iovlen = iov_count;
+        const ssize_t sent = ::sendmsg(connection.fd, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                updateInterest(connection_id, true);
+                return true;
+            }
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        EMODBUS_TRACE_INSTANT(DeviceWrite, 0, 0, static_cast<size_t>(sent), connection_id);
+        auto sent_left = static_cast<size_t>(sent);
+        for (Transaction &transaction: connection.inFlight) {
+            if (sent_left == 0)
+                break;
+            const size_t consumed = std::min<size_t>(sent_left, transaction.unsent);
+            transaction.unsent -= static_cast<uint16_t>(consumed);
+            sent_left -= consumed;
+        }
+    }
+    updateInterest(connection_id, false);
+    return true;
+}
+
+bool eModbus::MasterPool::receive(const ConnectionID connection_id, size_t &dispatched) {
+    Connection &connection = _connections[connection_id];
+    while (true) {
+        const std::span<uint8_t> free_space = std::span(connection.rxBuffer).subspan(connection.rxSize);
+        const ssize_t received = ::recv(connection.fd, free_space.data(), free_space.size(), 0);
+        if (received > 0) {
+            EMODBUS_TRACE_INSTANT(DeviceRead, 0, 0, static_cast<size_t>(received), connection_id);
+            connection.rxSize += static_cast<size_t>(received);
+            dispatchFrames(connection, dispatched);
+            if (connection.rxSize == connection.rxBuffer.size()) {
+                // a frame that does not fit the buffer can only be garbage
+                disconnect(connection_id, SerialError::BUFFER_TOO_SMALL, dispatched);
+                return false;
+            }
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        if (received < 0 && errno == EINTR)
+            continue;
+        // connection closed by the peer or failed
+        disconnect(connection_id, SerialError::INTERNAL_ERROR, dispatched);
+        return false;
+    }
+}
+
+void eModbus::MasterPool::dispatchFrames(Connection &connection, size_t &dispatched) {
+    size_t offset = 0;
+    while (connection.rxSize - offset >= Frame::MBAP_HEADER_SIZE) {
+        const uint8_t *header = connection.rxBuffer.data() + offset;
+        const size_t length = static_cast<size_t>(header[4] << 8 | header[5]);
+        const size_t adu_size = Frame::MBAP_HEADER_SIZE - Frame::UNIT_ID_SIZE + length;
+        if (length == 0 || adu_size > MAX_TCP_ADU_SIZE) {
+            // stream lost its framing, drop everything received so far
+            offset = connection.rxSize;
+            break;
+        }
+        if (connection.rxSize - offset < adu_size)
+            break;
+
+        Frame response = Frame::fromRawTcpData(std::span(header, adu_size), false);
+        offset += adu_size;
+
+        const auto it = std::ranges::find_if(connection.inFlight, [&response](const Transaction &transaction) {
+            return transaction.frame.transactionID() == response.transactionID();
+        });
+        if (it == connection.inFlight.end())
+            continue; // late answer for an expired transaction
+
+        Transaction transaction = std::move(*it);
+        connection.inFlight.erase(it);
+        const bool valid = response.validateTCP() == Frame::ValidationStatus::OK
+                           && response.slaveID() == transaction.frame.slaveID()
+                           && response.functionCode() == transaction.frame.functionCode();
+        transaction.callback(valid ? SerialError::SUCCESS : SerialError::INTERNAL_ERROR, response);
+        ++dispatched;
+    }
+    if (offset != 0) {
+        std::memmove(connection.rxBuffer.data(), connection.rxBuffer.data() + offset, connection.rxSize - offset);
+        connection.rxSize -= offset;
+    }
+}
+
+bool eModbus::MasterPool::expire(Connection &connection, const Clock::time_point now, size_t &dispatched) {
+    // requests waiting for the connection or the window time out the same as the ones on the wire
+    // (taken out first, a callback may submit() to this connection)
+    std::vector<Transaction> expired;
+    for (auto it = connection.queued.begin(); it != connection.queued.end();) {
+        if (it->deadline > now) {
+            ++it;
+            continue;
+        }
+        expired.push_back(std::move(*it));
+        it = connection.queued.erase(it);
+    }
+    for (Transaction &transaction: expired) {
+        transaction.callback(SerialError::TIMEOUT, transaction.frame);
+        ++dispatched;
+    }
+    // a SYN that went nowhere would otherwise wait for the kernel's connect timeout, minutes
+    if (connection.state == State::Connecting && connection.connectDeadline <= now)
+        return false;
+    // unsent bytes are a suffix of the window: requests not started yet can leave it like queued ones,
+    // only one the socket took part of forces a disconnect, the rest of its ADU would desync the stream
+    bool partially_sent = false;
+    expired.clear();
+    for (auto it = connection.inFlight.begin(); it != connection.inFlight.end();) {
+        if (it->deadline > now) {
+            ++it;
+            continue;
+        }
+        if (it->unsent != 0 && it->unsent < it->frame.tcpFrameSize()) {
+            partially_sent = true;
+            break;
+        }
+        expired.push_back(std::move(*it));
+        it = connection.inFlight.erase(it);
+    }
+    for (Transaction &transaction: expired) {
+        transaction.callback(SerialError::TIMEOUT, transaction.frame);
+        ++dispatched;
+    }
+    return !partially_sent;
+}
+
+eModbus::MasterPool::Clock::time_point eModbus::MasterPool::nearestDeadline(Clock::time_point fallback) const {
+    for (const Connection &connection: _connections) {
+        for (const Transaction &transaction: connection.inFlight)
+            fallback = std::min(fallback, transaction.deadline);
+        for (const Transaction &transaction: connection.queued)
+            fallback = std::min(fallback, transaction.deadline);
+        if (connection.state == State::Connecting)
+            fallback = std::min(fallback, connection.connectDeadline);
+        if (connection.state == State::Disconnected && !connection.queued.empty())
+            fallback = std::min(fallback, connection.reconnectAt);
+    }
+    return fallback;
+}
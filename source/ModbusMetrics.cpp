@@ -0,0 +1,141 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include "ModbusMetrics.hpp"
+
+namespace {
+    constexpr const char *counterNames[] = {
+        "transactions", "timeouts", "invalid_frames", "crc_errors", "exceptions", "stream_failures", "retries",
+    };
+    static_assert(std::size(counterNames) == eModbus::Metrics::CounterCount);
+
+    void appendHistogramText(std::string &out, const char *name, const eModbus::LatencyHistogram::Snapshot &h) {
+        out += name;
+        out += ": n=" + std::to_string(h.count);
+        out += " mean=" + std::to_string(static_cast<uint64_t>(h.mean_us())) + "us";
+        out += " p50=" + std::to_string(h.percentile_us(50)) + "us";
+        out += " p90=" + std::to_string(h.percentile_us(90)) + "us";
+        out += " p99=" + std::to_string(h.percentile_us(99)) + "us";
+        out += " max=" + std::to_string(h.max_us) + "us\n";
+    }
+
+    void appendHistogramJson(std::string &out, const eModbus::LatencyHistogram::Snapshot &h) {
+        out += "{\"count\":" + std::to_string(h.count);
+        out += ",\"mean_us\":" + std::to_string(h.mean_us());
+        out += ",\"p50_us\":" + std::to_string(h.percentile_us(50));
+        out += ",\"p90_us\":" + std::to_string(h.percentile_us(90));
+        out += ",\"p99_us\":" + std::to_string(h.percentile_us(99));
+        out += ",\"max_us\":" + std::to_string(h.max_us) + "}";
+    }
+
+    void appendBlockText(std::string &out, const std::string &title, const eModbus::Metrics::BlockSnapshot &block) {
+        out += title + ":";
+        for (size_t i = 0; i < eModbus::Metrics::CounterCount; ++i)
+            out += std::string(" ") + counterNames[i] + "=" + std::to_string(block.counters[i]);
+        out += "\n  ";
+        appendHistogramText(out, "round_trip", block.roundTrip);
+    }
+
+    void appendBlockJson(std::string &out, const eModbus::Metrics::BlockSnapshot &block) {
+        out += "{";
+        for (size_t i = 0; i < eModbus::Metrics::CounterCount; ++i)
+            out += std::string("\"") + counterNames[i] + "\":" + std::to_string(block.counters[i]) + ",";
+        out += "\"round_trip\":";
+        appendHistogramJson(out, block.roundTrip);
+        out += "}";
+    }
+}
+
+eModbus::Metrics::BlockSnapshot eModbus::Metrics::snapshotOf(const Block &block) {
+    BlockSnapshot result;
+    for (size_t i = 0; i < CounterCount; ++i)
+        result.counters[i] = block.counters[i].load(std::memory_order_relaxed);
+    result.roundTrip = block.roundTrip.snapshot();
+    return result;
+}
+
+eModbus::Metrics::Snapshot eModbus::Metrics::snapshot() const {
+    Snapshot result;
+    const auto elapsed = Clock::now().time_since_epoch().count() - start_ns_.load(std::memory_order_relaxed);
+    result.elapsed_s = std::chrono::duration<double>(Clock::duration(elapsed)).count();
+    if (result.elapsed_s > 0)
+        result.busOccupancy = static_cast<double>(busy_us_.load(std::memory_order_relaxed)) / 1e6 / result.elapsed_s;
+    result.total = snapshotOf(total_);
+    result.send = send_.snapshot();
+    result.turnaround = turnaround_.snapshot();
+    result.receive = receive_.snapshot();
+    for (size_t i = 0; i < SlaveCount; ++i) {
+        if (const Block *block = slaves_[i].load(std::memory_order_acquire))
+            result.slaves.emplace_back(static_cast<uint8_t>(i), snapshotOf(*block));
+    }
+    for (size_t i = 0; i < FunctionCodeCount; ++i) {
+        if (const Block *block = functionCodes_[i].load(std::memory_order_acquire))
+            result.functionCodes.emplace_back(static_cast<uint8_t>(i), snapshotOf(*block));
+    }
+    return result;
+}
+
+std::string eModbus::Metrics::toText() const {
+    const Snapshot data = snapshot();
+    std::string out;
+    out += "elapsed=" + std::to_string(data.elapsed_s) + "s bus_occupancy="
+            + std::to_string(data.busOccupancy * 100.0) + "%\n";
+    appendBlockText(out, "total", data.total);
+    appendHistogramText(out, "send", data.send);
+    appendHistogramText(out, "turnaround", data.turnaround);
+    appendHistogramText(out, "receive", data.receive);
+    for (const auto &[slave_ID, block]: data.slaves)
+        appendBlockText(out, "slave " + std::to_string(slave_ID), block);
+    for (const auto &[function_code, block]: data.functionCodes)
+        appendBlockText(out, "function " + std::to_string(function_code), block);
+    return out;
+}
+
+std::string eModbus::Metrics::toJson() const {
+    const Snapshot data = snapshot();
+    std::string out;
+    out += "{\"elapsed_s\":" + std::to_string(data.elapsed_s);
+    out += ",\"bus_occupancy\":" + std::to_string(data.busOccupancy);
+    out += ",\"total\":";
+    appendBlockJson(out, data.total);
+    out += ",\"send\":";
+    appendHistogramJson(out, data.send);
+    out += ",\"turnaround\":";
+    appendHistogramJson(out, data.turnaround);
+    out += ",\"receive\":";
+    appendHistogramJson(out, data.receive);
+    out += ",\"slaves\":{";
+    for (size_t i = 0; i < data.slaves.size(); ++i) {
+        out += (i ? ",\"" : "\"") + std::to_string(data.slaves[i].first) + "\":";
+        appendBlockJson(out, data.slaves[i].second);
+    }
+    out += "},\"function_codes\":{";
+    for (size_t i = 0; i < data.functionCodes.size(); ++i) {
+        out += (i ? ",\"" : "\"") + std::to_string(data.functionCodes[i].first) + "\":";
+        appendBlockJson(out, data.functionCodes[i].second);
+    }
+    out += "}}";
+    return out;
+}
+
+void eModbus::Metrics::reset() {
+    auto reset_block = [](Block &block) {
+        for (auto &counter: block.counters)
+            counter.store(0, std::memory_order_relaxed);
+        block.roundTrip.reset();
+    };
+    reset_block(total_);
+    for (auto &block: slaves_) {
+        if (Block *existing = block.load(std::memory_order_acquire))
+            reset_block(*existing);
+    }
+    for (auto &block: functionCodes_) {
+        if (Block *existing = block.load(std::memory_order_acquire))
+            reset_block(*existing);
+    }
+    send_.reset();
+    turnaround_.reset();
+    receive_.reset();
+    busy_us_.store(0, std::memory_order_relaxed);
+    start_ns_.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
@@ -0,0 +1,215 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include "ModbusPollScheduler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include "ModbusMasterTag.hpp"
+
+eModbus::PollScheduler::PollScheduler()
+    : now_us{[] {
+          return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now().time_since_epoch()).count());
+      }},
+      sleepUntil_us{[](const uint64_t time_us) {
+          std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::microseconds(time_us)));
+      }} {
+}
+
+eModbus::PollScheduler::GroupID eModbus::PollScheduler::addGroup(Group group) {
+    if (group.period_us == 0)
+        throw std::invalid_argument("Polling period must not be 0");
+    Entry &entry = groups_.emplace_back();
+    entry.id = nextID_++;
+    entry.group = std::move(group);
+    entry.release_us = now_us();
+    entry.statistics.effectivePeriod_us = entry.group.period_us;
+    return entry.id;
+}
+
+void eModbus::PollScheduler::removeGroup(const GroupID group) {
+    std::erase_if(groups_, [group](const Entry &entry) { return entry.id == group; });
+    adaptPeriods();
+}
+
+void eModbus::PollScheduler::clear() {
+    groups_.clear();
+}
+
+size_t eModbus::PollScheduler::pollOnce(MasterTag &master) {
+    const uint64_t now = now_us();
+    const Entry *earliest = nullptr;
+    for (const Entry &entry: groups_) {
+        if (entry.release_us > now)
+            continue;
+        if (!earliest || entry.deadline_us() < earliest->deadline_us()
+            || (entry.deadline_us() == earliest->deadline_us() && entry.group.priority < earliest->group.priority))
+            earliest = &entry;
+    }
+    if (!earliest)
+        return 0;
+
+    // everything released on the same slave rides along, the union of the tags is planned as one set
+    const uint8_t slave_ID = earliest->group.slaveID;
+    batch_.clear();
+    tags_.clear();
+    size_t batchTags = 0;
+    for (size_t i = 0; i < groups_.size(); ++i) {
+        const Entry &entry = groups_[i];
+        if (entry.release_us <= now && entry.group.slaveID == slave_ID) {
+            batch_.push_back(i);
+            tags_.insert(tags_.end(), entry.group.tags.begin(), entry.group.tags.end());
+            batchTags += entry.group.tags.size();
+        }
+    }
+    // sorted, so the same groups falling due together hit the same cached plan
+    std::ranges::sort(tags_);
+    const auto [duplicates, end] = std::ranges::unique(tags_);
+    tags_.erase(duplicates, end);
+
+    const ReadPlan *plan = nullptr;
+    std::exception_ptr planFailure;
+    try {
+        plan = &master.readPlan(slave_ID, tags_);
+    } catch (const std::exception &) {
+        planFailure = std::current_exception();
+    }
+
+    // request by request, so a bad address or a timeout costs only the tags of that request
+    const uint64_t started = now_us();
+    failures_.clear();
+    failedTags_.clear();
+    if (plan) {
+        registers_.resize(plan->registerCount());
+        failures_.resize(plan->requests().size());
+        for (size_t request = 0; request < failures_.size(); ++request) {
+            try {
+                master.read(*plan, request, registers_);
+            } catch (const std::exception &) {
+                failures_[request] = std::current_exception();
+            }
+        }
+        for (const ReadPlan::Slot &slot: plan->slots())
+            if (failures_[slot.request])
+                failedTags_.push_back({slot.tag, slot.request}); // in slot order, so sorted by tag
+    }
+    const uint64_t completed = now_us();
+
+    const double cost = static_cast<double>(completed - started);
+    for (const size_t i: batch_) {
+        Entry &entry = groups_[i];
+        GroupStatistics &statistics = entry.statistics;
+        // the bus time is shared by tag count, which is what the groups would roughly cost on their own
+        const double share = batchTags ? cost * static_cast<double>(entry.group.tags.size()) / batchTags
+                                       : cost / static_cast<double>(batch_.size());
+        entry.cost_us = statistics.polls == 0 ? share : entry.cost_us + (share - entry.cost_us) / 4;
+        statistics.averageCost_us = static_cast<uint32_t>(entry.cost_us);
+        ++statistics.polls;
+        if (completed > entry.deadline_us())
+            ++statistics.deadlineMisses;
+        statistics.lastResponse_us = static_cast<uint32_t>(std::min<uint64_t>(
+            completed - entry.release_us, std::numeric_limits<uint32_t>::max()));
+        if (planFailure || failureOf(entry.group))
+            ++statistics.errors;
+
+        // releases missed while the bus was busy are dropped, not made up for in a burst
+        const uint64_t period = entry.period_us();
+        entry.release_us += period;
+        if (entry.release_us < completed)
+            entry.release_us += (completed - entry.release_us) / period * period;
+    }
+    adaptPeriods();
+
+    if (onError_) {
+        for (const size_t i: batch_) {
+            const std::exception_ptr failure = planFailure ? planFailure : failureOf(groups_[i].group);
+            if (!failure)
+                continue;
+            try {
+                std::rethrow_exception(failure);
+            } catch (const std::exception &error) {
+                onError_(groups_[i].id, error);
+            }
+        }
+    }
+    if (plan && onUpdate_) {
+        const std::span<const ReadPlan::Slot> slots = plan->slots();
+        for (size_t slot = 0; slot < slots.size(); ++slot)
+            if (!failures_[slots[slot].request])
+                onUpdate_(slave_ID, slots[slot].tag, plan->tagRegisters(registers_, slot));
+    }
+    return batch_.size();
+}
+
+std::exception_ptr eModbus::PollScheduler::failureOf(const Group &group) const {
+    for (const Handle tag: group.tags) {
+        const auto it = std::ranges::lower_bound(failedTags_, tag, {}, &std::pair<Handle, uint16_t>::first);
+        if (it != failedTags_.end() && it->first == tag)
+            return failures_[it->second];
+    }
+    return nullptr;
+}
+
+uint64_t eModbus::PollScheduler::nextRelease_us() const {
+    uint64_t next = std::numeric_limits<uint64_t>::max();
+    for (const Entry &entry: groups_)
+        next = std::min(next, entry.release_us);
+    return next;
+}
+
+void eModbus::PollScheduler::run(MasterTag &master) {
+    while (!stopped_->load(std::memory_order_relaxed)) {
+        if (pollOnce(master) == 0)
+            sleepUntil_us(std::min(nextRelease_us(), now_us() + MaxSleep_us));
+    }
+    stopped_->store(false, std::memory_order_relaxed);
+}
+
+double eModbus::PollScheduler::utilization() const {
+    double total = 0.0;
+    for (const Entry &entry: groups_)
+        total += entry.cost_us / entry.group.period_us;
+    return total;
+}
+
+const eModbus::PollScheduler::GroupStatistics &eModbus::PollScheduler::statistics(const GroupID group) const {
+    const auto it = std::ranges::find(groups_, group, &Entry::id);
+    if (it == groups_.end())
+        throw std::out_of_range("Unknown polling group");
+    return it->statistics;
+}
+
+void eModbus::PollScheduler::adaptPeriods() {
+    std::array<double, 256> demand{};
+    double total = 0.0;
+    for (const Entry &entry: groups_) {
+        const double utilization = entry.cost_us / entry.group.period_us;
+        demand[entry.group.priority] += utilization;
+        total += utilization;
+    }
+
+    // worked out from the nominal periods every time, so the stretch goes away with the load
+    std::array<double, 256> stretch;
+    stretch.fill(1.0);
+    for (size_t priority = demand.size() - 1; priority > 0 && total > targetUtilization; --priority) {
+        const double level = demand[priority];
+        if (level <= 0.0)
+            continue;
+        const double excess = total - targetUtilization;
+        const double factor = excess < level ? std::min(maxStretch, level / (level - excess)) : maxStretch;
+        stretch[priority] = factor;
+        total -= level - level / factor;
+    }
+
+    for (Entry &entry: groups_) {
+        entry.stretch = stretch[entry.group.priority];
+        entry.statistics.effectivePeriod_us = static_cast<uint32_t>(std::min<uint64_t>(
+            entry.period_us(), std::numeric_limits<uint32_t>::max()));
+    }
+}
@@ -0,0 +1,117 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include "ModbusRegisterImage.hpp"
+
+#include <algorithm>
+
+namespace {
+    /** bits first..first+count-1 of a page, count 1..64 */
+    uint64_t bitRange(const uint32_t first, const uint32_t count) {
+        const uint64_t bits = count >= 64 ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+        return bits << first;
+    }
+}
+
+eModbus::RegisterImage::Page &eModbus::RegisterImage::pageForWrite(const RegisterType register_type,
+                                                                  const uint32_t page_index) {
+    Directory *&directory = _directories[static_cast<size_t>(register_type) * DirectoriesPerType
+                                         + page_index / PagesPerDirectory];
+    if (directory == nullptr)
+        directory = new(_resource->allocate(sizeof(Directory), alignof(Directory))) Directory{};
+    Page *&page = directory->pages[page_index % PagesPerDirectory];
+    if (page == nullptr) {
+        page = new(_resource->allocate(sizeof(Page), alignof(Page))) Page{};
+        ++_pages;
+    }
+    return *page;
+}
+
+size_t eModbus::RegisterImage::write(const RegisterType register_type, const uint16_t start_address,
+                                     const std::span<const uint16_t> values, const bool mark_dirty) {
+    // values past the end of the address space are dropped
+    const uint32_t end = std::min<uint32_t>(start_address + values.size(), 0x10000);
+    size_t changed = 0;
+    for (uint32_t address = start_address; address < end;) {
+        Page &page = pageForWrite(register_type, address / PageSize);
+        const uint32_t first = address % PageSize;
+        const uint32_t count = std::min(PageSize - first, end - address);
+        const uint16_t *source = values.data() + (address - start_address);
+        uint64_t changed_bits = ~page.present & bitRange(first, count);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (page.values[first + i] != source[i]) {
+                page.values[first + i] = source[i];
+                changed_bits |= uint64_t{1} << (first + i);
+            }
+        }
+        page.present |= bitRange(first, count);
+        if (mark_dirty)
+            page.dirty |= changed_bits;
+        changed += static_cast<size_t>(std::popcount(changed_bits));
+        address += count;
+    }
+    return changed;
+}
+
+bool eModbus::RegisterImage::read(const RegisterType register_type, const uint16_t start_address,
+                                  const std::span<uint16_t> values) const {
+    const uint32_t end = std::min<uint32_t>(start_address + values.size(), 0x10000);
+    bool complete = end - start_address == values.size();
+    std::fill(values.begin() + (end - start_address), values.end(), 0);
+    for (uint32_t address = start_address; address < end;) {
+        const Page *page = this->page(register_type, address / PageSize);
+        const uint32_t first = address % PageSize;
+        const uint32_t count = std::min(PageSize - first, end - address);
+        uint16_t *destination = values.data() + (address - start_address);
+        if (page == nullptr) {
+            std::fill_n(destination, count, 0);
+            complete = false;
+        } else {
+            const uint64_t wanted = bitRange(first, count);
+            if ((page->present & wanted) == wanted) {
+                std::copy_n(page->values.begin() + first, count, destination);
+            } else {
+                complete = false;
+                for (uint32_t i = 0; i < count; ++i)
+                    destination[i] = page->present >> (first + i) & 1 ? page->values[first + i] : 0;
+            }
+        }
+        address += count;
+    }
+    return complete;
+}
+
+void eModbus::RegisterImage::clearDirty(const RegisterType register_type, const uint16_t start_address,
+                                        const uint32_t quantity) {
+    const uint32_t end = std::min<uint32_t>(start_address + quantity, 0x10000);
+    for (uint32_t address = start_address; address < end;) {
+        const uint32_t first = address % PageSize;
+        const uint32_t count = std::min(PageSize - first, end - address);
+        if (Page *found = page(register_type, address / PageSize); found != nullptr)
+            found->dirty &= ~bitRange(first, count);
+        address += count;
+    }
+}
+
+void eModbus::RegisterImage::clearDirty() {
+    for (Directory *directory: _directories) {
+        if (directory == nullptr)
+            continue;
+        for (Page *page: directory->pages)
+            if (page != nullptr)
+                page->dirty = 0;
+    }
+}
+
+void eModbus::RegisterImage::clear() {
+    for (Directory *&directory: _directories) {
+        if (directory == nullptr)
+            continue;
+        for (Page *page: directory->pages)
+            if (page != nullptr)
+                _resource->deallocate(page, sizeof(Page), alignof(Page));
+        _resource->deallocate(directory, sizeof(Directory), alignof(Directory));
+        directory = nullptr;
+    }
+    _pages = 0;
+}
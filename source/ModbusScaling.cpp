@@ -0,0 +1,96 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include "ModbusScaling.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+eModbus::ScalingPlan::Kind eModbus::ScalingPlan::kindOf(const Tag::modbus_parameter_type type) {
+    switch (type) {
+        case Tag::modbus_parameter_type::U16:
+            return U16;
+        case Tag::modbus_parameter_type::U32:
+            return U32;
+        case Tag::modbus_parameter_type::FLOAT:
+            return Float;
+        case Tag::modbus_parameter_type::U8:
+        case Tag::modbus_parameter_type::U8_LSB:
+            return LowByte;
+        case Tag::modbus_parameter_type::U8_MSB:
+            return HighByte;
+        case Tag::modbus_parameter_type::BOOL:
+            return Bool;
+        default:
+            return Text;
+    }
+}
+
+eModbus::ScalingPlan::ScalingPlan(const uint16_t startAddress, const RegisterType registerType,
+                                  const uint16_t numRegisters, const std::span<const Tag> tags)
+    : startAddress_{startAddress}, registerType_{registerType}, numRegisters_{numRegisters},
+      tagCount_{tags.size()} {
+    for (size_t i = 0; i < tags.size(); ++i) {
+        const Tag &tag = tags[i];
+        const Kind kind = kindOf(tag.register_value_type);
+        const uint16_t words = kind == U32 || kind == Float ? 2 : 1;
+        if (tag.register_type != registerType || tag.register_number < startAddress
+            || tag.register_number - startAddress + words > numRegisters)
+            throw std::out_of_range("Tag is outside of the register block");
+
+        Group &group = groups_[kind];
+        group.output.push_back(static_cast<uint32_t>(i));
+        group.offset.push_back(static_cast<uint16_t>(tag.register_number - startAddress));
+        const bool integer = kind != Float && kind != Bool && kind != Text;
+        group.scale.push_back(integer ? std::pow(10.0, -static_cast<double>(tag.precision)) : 1.0);
+        const bool limited = kind != Text && tag.min_value < tag.max_value;
+        group.min.push_back(limited ? tag.min_value : -std::numeric_limits<double>::infinity());
+        group.max.push_back(limited ? tag.max_value : std::numeric_limits<double>::infinity());
+    }
+}
+
+namespace {
+    /** one loop per kind, raw(registers, offset) gives the unscaled value */
+    template<typename Raw>
+    void decodeGroup(const std::span<const uint16_t> registers, const std::span<const uint32_t> output,
+                     const uint16_t *offset, const double *scale, const double *min, const double *max,
+                     const std::span<double> values, const std::span<uint8_t> flags, Raw raw) {
+        const uint16_t *data = registers.data();
+        for (size_t i = 0; i < output.size(); ++i) {
+            const double value = raw(data + offset[i]) * scale[i];
+            const bool below = value < min[i];
+            const bool above = value > max[i];
+            values[output[i]] = below ? min[i] : above ? max[i] : value;
+            if (!flags.empty())
+                flags[output[i]] = static_cast<uint8_t>(below * eModbus::ScalingPlan::BelowMin
+                                                        | above * eModbus::ScalingPlan::AboveMax);
+        }
+    }
+}
+
+void eModbus::ScalingPlan::decode(const std::span<const uint16_t> registers, const std::span<double> values,
+                                  const std::span<uint8_t> flags) const {
+    if (registers.size() < numRegisters_ || values.size() < tagCount_ || (!flags.empty() && flags.size() < tagCount_))
+        throw std::out_of_range("Register block or outputs smaller than the scaling plan");
+
+    auto run = [&](const Kind kind, auto raw) {
+        const Group &group = groups_[kind];
+        decodeGroup(registers, group.output, group.offset.data(), group.scale.data(), group.min.data(),
+                    group.max.data(), values, flags, raw);
+    };
+    run(U16, [](const uint16_t *r) { return static_cast<double>(r[0]); });
+    run(U32, [](const uint16_t *r) { return static_cast<double>(static_cast<uint32_t>(r[0]) << 16 | r[1]); });
+    run(Float, [](const uint16_t *r) {
+        return static_cast<double>(MODBUS_BIT_CAST<float>(static_cast<uint32_t>(r[0]) << 16 | r[1]));
+    });
+    run(LowByte, [](const uint16_t *r) { return static_cast<double>(getU8LSB(r[0])); });
+    run(HighByte, [](const uint16_t *r) { return static_cast<double>(getU8MSB(r[0])); });
+    run(Bool, [](const uint16_t *r) { return r[0] != 0 ? 1.0 : 0.0; });
+
+    for (const uint32_t output: groups_[Text].output) {
+        values[output] = std::numeric_limits<double>::quiet_NaN();
+        if (!flags.empty())
+            flags[output] = NotNumeric;
+    }
+}
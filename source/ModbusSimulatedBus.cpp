@@ -0,0 +1,275 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include "ModbusSimulatedBus.hpp"
+
+#include <algorithm>
+
+namespace {
+    constexpr uint16_t MAX_READ_BITS = 2000;
+}
+
+eModbus::SimulatedSlave &eModbus::SimulatedSlave::set(const RegisterType register_type, const uint16_t start_address,
+                                                      const std::span<const uint16_t> values) {
+    auto &map = registers[static_cast<int>(register_type)];
+    for (size_t i = 0; i < values.size(); ++i)
+        map[static_cast<uint16_t>(start_address + i)] = values[i];
+    return *this;
+}
+
+eModbus::SimulatedSlave &eModbus::SimulatedSlave::fill(const RegisterType register_type, const uint16_t start_address,
+                                                       const uint16_t quantity, const uint16_t value) {
+    auto &map = registers[static_cast<int>(register_type)];
+    for (uint32_t i = 0; i < quantity; ++i)
+        map[static_cast<uint16_t>(start_address + i)] = value;
+    return *this;
+}
+
+std::optional<uint16_t> eModbus::SimulatedSlave::get(const RegisterType register_type, const uint16_t address) const {
+    const auto &map = registers[static_cast<int>(register_type)];
+    if (const auto it = map.find(address); it != map.end())
+        return it->second;
+    return std::nullopt;
+}
+
+eModbus::SimulatedBus::SimulatedBus(const uint32_t baudrate, const uint32_t seed) : baudrate_{baudrate},
+    random_{seed} {
+}
+
+eModbus::SimulatedSlave &eModbus::SimulatedBus::addSlave(const uint8_t slave_ID, const uint32_t baudrate,
+                                                         const uint32_t turnaround_us) {
+    SimulatedSlave &result = slaves_[slave_ID];
+    result.slaveID = slave_ID;
+    result.baudrate = baudrate ? baudrate : baudrate_;
+    result.turnaround_us = turnaround_us;
+    return result;
+}
+
+eModbus::SimulatedSlave *eModbus::SimulatedBus::slave(const uint8_t slave_ID) {
+    const auto it = slaves_.find(slave_ID);
+    return it == slaves_.end() ? nullptr : &it->second;
+}
+
+double eModbus::SimulatedBus::utilization() const {
+    if (clock_.now_us() == 0)
+        return 0.0;
+    return static_cast<double>(statistics_.busBusy_us) / static_cast<double>(clock_.now_us());
+}
+
+uint32_t eModbus::SimulatedBus::characterTime_us(const uint32_t baudrate) {
+    return Frame::characterTime_us(baudrate);
+}
+
+uint32_t eModbus::SimulatedBus::t35_us(const uint32_t baudrate) {
+    return Frame::t35_us(baudrate);
+}
+
+bool eModbus::SimulatedBus::chance(const double probability) {
+    if (probability <= 0.0)
+        return false;
+    return static_cast<double>(random_()) < probability * static_cast<double>(std::mt19937::max());
+}
+
+SerialError eModbus::SimulatedBus::write(const std::span<const uint8_t> buffer, uint32_t,
+                                         size_t *bytes_written_out) {
+    EMODBUS_TRACE_INSTANT(DeviceWrite, 0, 0, buffer.size());
+    // A new request ends whatever the previous slave was still saying
+    response_.clear();
+    responseDelivered_ = 0;
+
+    const uint64_t start = std::max(clock_.now_us(), lineIdleSince_us_ + t35_us(baudrate_));
+    const uint64_t duration = static_cast<uint64_t>(buffer.size()) * characterTime_us(baudrate_);
+    clock_.advanceTo(start + duration);
+    lineIdleSince_us_ = clock_.now_us();
+    statistics_.busBusy_us += duration;
+    ++statistics_.requests;
+
+    if (bytes_written_out)
+        *bytes_written_out = buffer.size();
+
+    handleRequest(buffer);
+    return SerialError::SUCCESS;
+}
+
+SerialError eModbus::SimulatedBus::read(const std::span<uint8_t> buffer, const uint32_t timeout_ms,
+                                        size_t *bytes_read_out) {
+    const uint64_t deadline = clock_.now_us() + static_cast<uint64_t>(timeout_ms) * 1000;
+    const uint32_t character_us = characterTime_us(baudrate_);
+    const size_t remaining = response_.size() - responseDelivered_;
+
+    // bytes fully on the line by the deadline and not delivered yet
+    size_t available = 0;
+    if (remaining != 0 && deadline >= responseStart_us_) {
+        const auto on_line = static_cast<size_t>(
+            std::min<uint64_t>((deadline - responseStart_us_) / character_us, response_.size()));
+        if (on_line > responseDelivered_)
+            available = on_line - responseDelivered_;
+    }
+    const size_t count = std::min(available, buffer.size());
+    std::copy_n(response_.begin() + static_cast<ptrdiff_t>(responseDelivered_), count, buffer.begin());
+    responseDelivered_ += count;
+    EMODBUS_TRACE_INSTANT(DeviceRead, 0, 0, count);
+    if (bytes_read_out)
+        *bytes_read_out = count;
+
+    const uint64_t last_byte_end = responseStart_us_ + responseDelivered_ * character_us;
+    if (count == buffer.size() && count != 0) {
+        clock_.advanceTo(last_byte_end);
+        return SerialError::SUCCESS;
+    }
+    if (count != 0 && responseDelivered_ == response_.size()) {
+        // idle line after the last byte closes the frame
+        clock_.advanceTo(std::min(deadline, last_byte_end + t35_us(baudrate_)));
+        return SerialError::SUCCESS;
+    }
+    clock_.advanceTo(deadline);
+    return SerialError::TIMEOUT;
+}
+
+SerialError eModbus::SimulatedBus::flush() {
+    response_.clear();
+    responseDelivered_ = 0;
+    return SerialError::SUCCESS;
+}
+
+void eModbus::SimulatedBus::handleRequest(const std::span<const uint8_t> request) {
+    Frame frame = Frame::fromRawRtuData(request, true);
+    if (request.size() < Frame::RTU_HEADER_SIZE + Frame::CRC_SIZE
+        || frame.calculateRTULength() != request.size()
+        || frame.validateRTU() != Frame::ValidationStatus::OK)
+        return;
+
+    SimulatedSlave *target = slave(frame.slaveID());
+    // a slave listening at another baud rate sees only noise
+    if (target == nullptr || target->baudrate != baudrate_) {
+        ++statistics_.unanswered;
+        return;
+    }
+    if (chance(dropoutRate)) {
+        ++statistics_.dropped;
+        return;
+    }
+
+    Frame response = respond(*target, frame);
+    if (response.isException())
+        ++statistics_.exceptions;
+    const std::span<const uint8_t> bytes = response.rtuFrame();
+    response_.assign(bytes.begin(), bytes.end());
+    if (chance(crcErrorRate)) {
+        response_[random_() % response_.size()] ^= static_cast<uint8_t>(1u << (random_() % 8));
+        ++statistics_.corrupted;
+    }
+
+    const uint64_t duration = static_cast<uint64_t>(response_.size()) * characterTime_us(baudrate_);
+    responseStart_us_ = clock_.now_us() + target->turnaround_us;
+    lineIdleSince_us_ = responseStart_us_ + duration;
+    statistics_.busBusy_us += duration;
+    ++statistics_.responses;
+}
+
+eModbus::Frame eModbus::SimulatedBus::respond(SimulatedSlave &slave, Frame &request) {
+    const Frame::FunctionCode function_code = request.functionCode();
+    const uint16_t start = request.startAddress();
+    uint16_t quantity = request.registerCount();
+
+    auto exception = [&](const Frame::ExceptionCode code) {
+        return Frame::buildExceptionResponse(slave.slaveID, function_code, code);
+    };
+    auto all_present = [&](const RegisterType register_type) {
+        for (uint32_t i = 0; i < quantity; ++i) {
+            if (!slave.get(register_type, static_cast<uint16_t>(start + i)))
+                return false;
+        }
+        return true;
+    };
+
+    RegisterType register_type;
+    switch (function_code) {
+        case Frame::ReadCoils:
+        case Frame::WriteSingleCoil:
+        case Frame::WriteMultipleCoils:
+            register_type = RegisterType::Coil;
+            break;
+        case Frame::ReadDiscreteInputs:
+            register_type = RegisterType::DiscreteInput;
+            break;
+        case Frame::ReadInputRegisters:
+            register_type = RegisterType::AnalogInput;
+            break;
+        case Frame::ReadHoldingRegisters:
+        case Frame::WriteSingleRegister:
+        case Frame::WriteMultipleRegisters:
+            register_type = RegisterType::Holding;
+            break;
+        default:
+            return exception(Frame::IllegalFunction);
+    }
+
+    switch (function_code) {
+        case Frame::ReadCoils:
+        case Frame::ReadDiscreteInputs: {
+            if (quantity == 0 || quantity > MAX_READ_BITS)
+                return exception(Frame::IllegalDataValue);
+            if (!all_present(register_type))
+                return exception(Frame::IllegalDataAddress);
+            Frame response = Frame::build(false, slave.slaveID, function_code, start, 0);
+            response.byteCount(static_cast<uint8_t>((quantity + 7) / 8));
+            const std::span<uint8_t> bits = response.registersData();
+            std::ranges::fill(bits, 0);
+            for (uint16_t i = 0; i < quantity; ++i) {
+                if (slave.get(register_type, static_cast<uint16_t>(start + i)).value())
+                    bits[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+            }
+            return response;
+        }
+        case Frame::ReadHoldingRegisters:
+        case Frame::ReadInputRegisters: {
+            if (quantity == 0 || quantity > MAX_MODBUS_REGISTERS)
+                return exception(Frame::IllegalDataValue);
+            if (!all_present(register_type))
+                return exception(Frame::IllegalDataAddress);
+            std::array<uint16_t, MAX_MODBUS_REGISTERS> values{};
+            for (uint16_t i = 0; i < quantity; ++i)
+                values[i] = slave.get(register_type, static_cast<uint16_t>(start + i)).value();
+            return Frame::build(false, slave.slaveID, function_code, start, quantity,
+                                std::span(values).first(quantity));
+        }
+        case Frame::WriteSingleCoil:
+        case Frame::WriteSingleRegister: {
+            quantity = 1;
+            if (!all_present(register_type))
+                return exception(Frame::IllegalDataAddress);
+            std::vector<uint16_t> value = request.registersValues();
+            uint16_t stored = value.at(0);
+            if (function_code == Frame::WriteSingleCoil) {
+                if (stored != 0xFF00 && stored != 0x0000)
+                    return exception(Frame::IllegalDataValue);
+                stored = stored ? 1 : 0;
+            }
+            slave.registers[static_cast<int>(register_type)][start] = stored;
+            return Frame::build(false, slave.slaveID, function_code, start, 1, value);
+        }
+        case Frame::WriteMultipleCoils: {
+            if (!all_present(register_type))
+                return exception(Frame::IllegalDataAddress);
+            const std::span<uint8_t> bits = request.registersData();
+            if (bits.size() * 8 < quantity)
+                return exception(Frame::IllegalDataValue);
+            for (uint16_t i = 0; i < quantity; ++i)
+                slave.registers[static_cast<int>(register_type)][static_cast<uint16_t>(start + i)] =
+                        (bits[i / 8] >> (i % 8)) & 0x1;
+            return Frame::build(false, slave.slaveID, function_code, start, quantity);
+        }
+        case Frame::WriteMultipleRegisters: {
+            if (!all_present(register_type))
+                return exception(Frame::IllegalDataAddress);
+            const std::vector<uint16_t> values = request.registersValues();
+            if (values.size() < quantity)
+                return exception(Frame::IllegalDataValue);
+            slave.set(register_type, start, std::span(values).first(quantity));
+            return Frame::build(false, slave.slaveID, function_code, start, quantity);
+        }
+        default:
+            return exception(Frame::IllegalFunction);
+    }
+}
@@ -0,0 +1,44 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include "ModbusTagDatabase.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+void eModbus::TagDatabase::assign(const std::span<const Tag> tags) {
+    clear();
+    std::vector<size_t> order(tags.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::ranges::stable_sort(order, [&tags](const size_t a, const size_t b) {
+        return (tags[a].register_type < tags[b].register_type) ||
+               (tags[a].register_type == tags[b].register_type && tags[a].register_number < tags[b].register_number);
+    });
+
+    registerTypes_.reserve(tags.size());
+    registerNumbers_.reserve(tags.size());
+    registerLengths_.reserve(tags.size());
+    valueTypes_.reserve(tags.size());
+    metadata_.reserve(tags.size());
+    for (const size_t index: order) {
+        const Tag &tag = tags[index];
+        registerTypes_.push_back(tag.register_type);
+        registerNumbers_.push_back(tag.register_number);
+        registerLengths_.push_back(tag.register_length);
+        valueTypes_.push_back(tag.register_value_type);
+        metadata_.push_back(tag);
+    }
+
+    keys_.reserve(metadata_.size());
+    for (Handle handle = 0; handle < metadata_.size(); ++handle)
+        keys_.emplace(metadata_[handle].key, handle);
+}
+
+void eModbus::TagDatabase::clear() {
+    keys_.clear();
+    registerTypes_.clear();
+    registerNumbers_.clear();
+    registerLengths_.clear();
+    valueTypes_.clear();
+    metadata_.clear();
+}
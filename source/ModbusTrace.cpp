@@ -0,0 +1,191 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include "ModbusTrace.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+
+namespace {
+    constexpr char TRACE_MAGIC[8] = {'E', 'M', 'B', 'T', 'R', 'C', '0', '1'};
+    constexpr size_t FILE_RECORD_SIZE = 20;
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<eModbus::trace::ThreadBuffer> > buffers;
+    };
+
+    Registry &registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    eModbus::trace::ThreadBuffer *registerThread() {
+        Registry &instance = registry();
+        std::lock_guard lock(instance.mutex);
+        const auto thread = static_cast<uint32_t>(instance.buffers.size() + 1);
+        return instance.buffers.emplace_back(std::make_unique<eModbus::trace::ThreadBuffer>(thread)).get();
+    }
+
+    void putLE(uint8_t *destination, uint64_t value, const size_t size) {
+        for (size_t i = 0; i < size; ++i, value >>= 8)
+            destination[i] = static_cast<uint8_t>(value);
+    }
+
+    uint64_t getLE(const uint8_t *source, const size_t size) {
+        uint64_t result = 0;
+        for (size_t i = size; i-- > 0;)
+            result = result << 8 | source[i];
+        return result;
+    }
+
+    const char *phaseType(const eModbus::trace::Phase phase) {
+        switch (phase) {
+            case eModbus::trace::Phase::Begin:
+                return "B";
+            case eModbus::trace::Phase::End:
+                return "E";
+            default:
+                return "i";
+        }
+    }
+}
+
+const char *eModbus::trace::to_string(const Event event) {
+    switch (event) {
+        case Event::FrameBuilt:
+            return "FrameBuilt";
+        case Event::FrameValidated:
+            return "FrameValidated";
+        case Event::Transaction:
+            return "Transaction";
+        case Event::Send:
+            return "Send";
+        case Event::Receive:
+            return "Receive";
+        case Event::DeviceWrite:
+            return "DeviceWrite";
+        case Event::DeviceRead:
+            return "DeviceRead";
+        default:
+            return "Unknown";
+    }
+}
+
+eModbus::trace::ThreadBuffer &eModbus::trace::threadBuffer() {
+    thread_local ThreadBuffer *buffer = registerThread();
+    return *buffer;
+}
+
+void eModbus::trace::ThreadBuffer::copyTo(std::vector<ThreadRecord> &out) const {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    const uint64_t first = std::max(tail_.load(std::memory_order_relaxed), head > Capacity ? head - Capacity : 0);
+    const size_t start = out.size();
+    for (uint64_t i = first; i < head; ++i) {
+        const Slot &slot = slots_[i & (Capacity - 1)];
+        const std::array<uint64_t, 2> words{slot[0].load(std::memory_order_relaxed),
+                                            slot[1].load(std::memory_order_relaxed)};
+        out.push_back({thread_, std::bit_cast<Record>(words)});
+    }
+    // the writer may have lapped us while copying: slots of records before head_after - Capacity hold newer ones,
+    // and the slot of head_after itself may be half written
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t head_after = head_.load(std::memory_order_relaxed);
+    if (head_after + 1 > first + Capacity) {
+        const auto overwritten = static_cast<size_t>(std::min<uint64_t>(head_after + 1 - Capacity - first,
+                                                                        head - first));
+        out.erase(out.begin() + static_cast<ptrdiff_t>(start),
+                  out.begin() + static_cast<ptrdiff_t>(start + overwritten));
+    }
+}
+
+std::vector<eModbus::trace::ThreadRecord> eModbus::trace::collect() {
+    std::vector<ThreadRecord> result;
+    {
+        Registry &instance = registry();
+        std::lock_guard lock(instance.mutex);
+        for (const auto &buffer: instance.buffers)
+            buffer->copyTo(result);
+    }
+    std::ranges::stable_sort(result, {}, [](const ThreadRecord &entry) { return entry.record.timestamp_ns; });
+    return result;
+}
+
+void eModbus::trace::clear() {
+    Registry &instance = registry();
+    std::lock_guard lock(instance.mutex);
+    for (const auto &buffer: instance.buffers)
+        buffer->clear();
+}
+
+bool eModbus::trace::save(const std::string &path, const std::span<const ThreadRecord> records) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+    file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    uint8_t data[FILE_RECORD_SIZE];
+    for (const auto &[thread, record]: records) {
+        putLE(data, thread, 4);
+        putLE(data + 4, record.timestamp_ns, 8);
+        data[12] = static_cast<uint8_t>(record.event);
+        data[13] = static_cast<uint8_t>(record.phase);
+        data[14] = record.slaveID;
+        data[15] = record.functionCode;
+        putLE(data + 16, record.length, 2);
+        putLE(data + 18, record.detail, 2);
+        file.write(reinterpret_cast<const char *>(data), sizeof(data));
+    }
+    return static_cast<bool>(file);
+}
+
+std::vector<eModbus::trace::ThreadRecord> eModbus::trace::load(const std::string &path) {
+    std::vector<ThreadRecord> result;
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (content.size() < sizeof(TRACE_MAGIC) || !std::equal(std::begin(TRACE_MAGIC), std::end(TRACE_MAGIC),
+                                                            content.begin()))
+        return result;
+    for (size_t position = sizeof(TRACE_MAGIC); position + FILE_RECORD_SIZE <= content.size();
+         position += FILE_RECORD_SIZE) {
+        const uint8_t *data = content.data() + position;
+        result.push_back({
+            static_cast<uint32_t>(getLE(data, 4)),
+            {
+                .timestamp_ns = getLE(data + 4, 8),
+                .event = static_cast<Event>(data[12]),
+                .phase = static_cast<Phase>(data[13]),
+                .slaveID = data[14],
+                .functionCode = data[15],
+                .length = static_cast<uint16_t>(getLE(data + 16, 2)),
+                .detail = static_cast<uint16_t>(getLE(data + 18, 2)),
+            }
+        });
+    }
+    return result;
+}
+
+std::string eModbus::trace::toChromeJson(const std::span<const ThreadRecord> records) {
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    const uint64_t origin = records.empty() ? 0 : records.front().record.timestamp_ns;
+    char line[256];
+    bool first = true;
+    for (const auto &[thread, record]: records) {
+        const uint64_t offset_ns = record.timestamp_ns - std::min(origin, record.timestamp_ns);
+        std::snprintf(line, sizeof(line),
+                      "%s\n{\"name\":\"%s\",\"ph\":\"%s\",%s\"ts\":%" PRIu64 ".%03u,\"pid\":1,\"tid\":%" PRIu32
+                      ",\"args\":{\"slave\":%u,\"fc\":%u,\"length\":%u,\"detail\":%u}}",
+                      first ? "" : ",", to_string(record.event), phaseType(record.phase),
+                      record.phase == Phase::Instant ? "\"s\":\"t\"," : "",
+                      offset_ns / 1000, static_cast<unsigned>(offset_ns % 1000), thread,
+                      record.slaveID, record.functionCode, record.length, record.detail);
+        out += line;
+        first = false;
+    }
+    out += "\n]}\n";
+    return out;
+}
@@ -0,0 +1,32 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+
+#ifndef TESTTAGS_HPP
+#define TESTTAGS_HPP
+#include <string>
+#include <vector>
+
+#include "ModbusTag.hpp"
+
+namespace eModbus::test {
+    /** @brief One-register holding tag. */
+    inline Tag holdingTag(const std::string &key, const uint16_t number) {
+        Tag tag{};
+        tag.key = key;
+        tag.register_type = RegisterType::Holding;
+        tag.register_number = number;
+        tag.register_length = 1;
+        return tag;
+    }
+
+    /** @brief count one-register holding tags "t0", "t1", ... at registers 0, 1, ... */
+    inline std::vector<Tag> holdingTags(const uint16_t count) {
+        std::vector<Tag> tags;
+        for (uint16_t number = 0; number < count; ++number)
+            tags.push_back(holdingTag("t" + std::to_string(number), number));
+        return tags;
+    }
+}
+
+#endif //TESTTAGS_HPP
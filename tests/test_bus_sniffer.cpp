@@ -0,0 +1,122 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ModbusBusSniffer.hpp"
+
+using namespace eModbus;
+
+namespace {
+    std::vector<uint8_t> bytesOf(Frame frame) {
+        const std::span<const uint8_t> bytes = frame.rtuFrame();
+        return {bytes.begin(), bytes.end()};
+    }
+
+    std::vector<uint8_t> readRequest(const uint8_t slave_ID, const Frame::FunctionCode function_code,
+                                     const uint16_t start_address, const uint16_t quantity) {
+        return bytesOf(Frame::build(true, slave_ID, function_code, start_address, quantity));
+    }
+
+    std::vector<uint8_t> readResponse(const uint8_t slave_ID, const Frame::FunctionCode function_code,
+                                      const uint16_t start_address, std::vector<uint16_t> values) {
+        return bytesOf(Frame::build(false, slave_ID, function_code, start_address,
+                                    static_cast<uint16_t>(values.size()), values));
+    }
+
+    std::vector<uint8_t> operator+(std::vector<uint8_t> first, const std::vector<uint8_t> &second) {
+        first.insert(first.end(), second.begin(), second.end());
+        return first;
+    }
+}
+
+TEST(BusSniffer, ValidPairsFillTheImage) {
+    BusSniffer sniffer;
+    const std::vector<uint8_t> stream =
+            readRequest(1, Frame::ReadHoldingRegisters, 10, 3)
+            + readResponse(1, Frame::ReadHoldingRegisters, 10, {100, 101, 102})
+            + readRequest(2, Frame::ReadInputRegisters, 0, 2)
+            + readResponse(2, Frame::ReadInputRegisters, 0, {7, 8});
+
+    // byte by byte, as a driver with a small FIFO would hand them over
+    size_t decoded = 0;
+    for (const uint8_t byte: stream)
+        decoded += sniffer.feed(std::span(&byte, 1));
+
+    EXPECT_EQ(decoded, 4u);
+    const BusSniffer::Statistics &statistics = sniffer.statistics();
+    EXPECT_EQ(statistics.requests, 2u);
+    EXPECT_EQ(statistics.responses, 2u);
+    EXPECT_EQ(statistics.exceptions, 0u);
+    EXPECT_EQ(statistics.crcErrors, 0u);
+    EXPECT_EQ(statistics.unmatched, 0u);
+    EXPECT_EQ(statistics.bytesSkipped, 0u);
+
+    std::array<uint16_t, 3> holding{};
+    EXPECT_TRUE(sniffer.read(1, RegisterType::Holding, 10, holding));
+    EXPECT_EQ(holding, (std::array<uint16_t, 3>{100, 101, 102}));
+    EXPECT_EQ(sniffer.get(2, RegisterType::AnalogInput, 1), 8);
+    EXPECT_EQ(sniffer.get(1, RegisterType::Holding, 13), std::nullopt);
+    ASSERT_NE(sniffer.slave(1), nullptr);
+    EXPECT_EQ(sniffer.slave(1)->updates, 1u);
+}
+
+TEST(BusSniffer, CrcDamagedResponseIsDropped) {
+    BusSniffer sniffer;
+    std::vector<uint8_t> damaged = readResponse(1, Frame::ReadHoldingRegisters, 10, {100, 101});
+    damaged[4] ^= 0x10; // a data byte, the announced length stays right
+    const std::vector<uint8_t> stream =
+            readRequest(1, Frame::ReadHoldingRegisters, 10, 2) + damaged
+            + readRequest(1, Frame::ReadHoldingRegisters, 20, 1)
+            + readResponse(1, Frame::ReadHoldingRegisters, 20, {200});
+
+    EXPECT_EQ(sniffer.feed(stream), 3u);
+
+    const BusSniffer::Statistics &statistics = sniffer.statistics();
+    EXPECT_EQ(statistics.requests, 2u);
+    EXPECT_EQ(statistics.responses, 1u);
+    EXPECT_EQ(statistics.crcErrors, 1u);
+    EXPECT_EQ(statistics.unmatched, 0u);
+    EXPECT_EQ(statistics.bytesSkipped, damaged.size());
+    EXPECT_EQ(sniffer.get(1, RegisterType::Holding, 10), std::nullopt);
+    EXPECT_EQ(sniffer.get(1, RegisterType::Holding, 20), 200);
+}
+
+TEST(BusSniffer, LeadingGarbageIsSkipped) {
+    BusSniffer sniffer;
+    const std::vector<uint8_t> garbage{0xFF, 0xFF, 0x00, 0x13};
+    const std::vector<uint8_t> stream =
+            garbage
+            + readRequest(5, Frame::ReadHoldingRegisters, 0, 1)
+            + readResponse(5, Frame::ReadHoldingRegisters, 0, {0xBEEF});
+
+    EXPECT_EQ(sniffer.feed(stream), 2u);
+
+    const BusSniffer::Statistics &statistics = sniffer.statistics();
+    EXPECT_EQ(statistics.bytesSkipped, garbage.size());
+    EXPECT_EQ(statistics.requests, 1u);
+    EXPECT_EQ(statistics.responses, 1u);
+    EXPECT_EQ(statistics.crcErrors, 0u);
+    EXPECT_EQ(sniffer.get(5, RegisterType::Holding, 0), 0xBEEF);
+}
+
+TEST(BusSniffer, ExceptionResponseLeavesImageAlone) {
+    BusSniffer sniffer;
+    const std::vector<uint8_t> stream =
+            readRequest(3, Frame::ReadHoldingRegisters, 100, 4)
+            + bytesOf(Frame::buildExceptionResponse(3, Frame::ReadHoldingRegisters, Frame::IllegalDataAddress));
+
+    EXPECT_EQ(sniffer.feed(stream), 2u);
+
+    const BusSniffer::Statistics &statistics = sniffer.statistics();
+    EXPECT_EQ(statistics.requests, 1u);
+    EXPECT_EQ(statistics.responses, 1u);
+    EXPECT_EQ(statistics.exceptions, 1u);
+    EXPECT_EQ(statistics.unmatched, 0u);
+    EXPECT_EQ(statistics.bytesSkipped, 0u);
+    EXPECT_EQ(sniffer.slave(3), nullptr);
+}
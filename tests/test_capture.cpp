@@ -0,0 +1,65 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ModbusCaptureDevice.hpp"
+
+using namespace eModbus;
+
+namespace {
+    /** takes every write whole, never has anything to read */
+    class SinkDevice : public IStreamDevice {
+    public:
+        SerialError read(std::span<uint8_t>, uint32_t, size_t *bytes_read_out = nullptr) override {
+            if (bytes_read_out != nullptr)
+                *bytes_read_out = 0;
+            return SerialError::TIMEOUT;
+        }
+
+        SerialError write(const std::span<const uint8_t> buffer, uint32_t, size_t *bytes_written_out = nullptr) override {
+            if (bytes_written_out != nullptr)
+                *bytes_written_out = buffer.size();
+            return SerialError::SUCCESS;
+        }
+
+        SerialError flush() override {
+            return SerialError::SUCCESS;
+        }
+
+    private:
+        void onTxComplete() override {
+        }
+
+        void onRxComplete(uint16_t) override {
+        }
+    };
+}
+
+TEST(RecordingStreamDevice, RecordLargerThanTheMappingGrowsItEnough) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "eModbus_test_capture.bin";
+    std::vector<uint8_t> large(UINT16_MAX);
+    for (size_t i = 0; i < large.size(); ++i)
+        large[i] = static_cast<uint8_t>(i * 7);
+    {
+        SinkDevice sink;
+        // 4 KiB mapping, the record alone needs 16 of them
+        RecordingStreamDevice recorder(sink, path.string(), 4096);
+        EXPECT_EQ(recorder.write(large, 100), SerialError::SUCCESS);
+        EXPECT_EQ(recorder.write(std::span(large).first(10), 100), SerialError::SUCCESS);
+    }
+
+    capture::Reader reader(path.string());
+    std::vector<capture::Record> writes;
+    while (const std::optional<capture::Record> record = reader.next())
+        if (record->direction == capture::Direction::Write)
+            writes.push_back(*record);
+    ASSERT_EQ(writes.size(), 2u);
+    EXPECT_TRUE(std::ranges::equal(writes[0].data, large));
+    EXPECT_EQ(writes[1].data.size(), 10u);
+    std::filesystem::remove(path);
+}
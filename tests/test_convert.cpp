@@ -0,0 +1,105 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ModbusConvert.hpp"
+
+using namespace eModbus;
+
+namespace {
+    /** value counts around the 8 register blocks of the SIMD path, so the scalar tail runs too */
+    constexpr std::array<size_t, 10> Counts{0, 1, 3, 4, 7, 8, 9, 15, 17, 33};
+
+    std::vector<uint16_t> pseudoRandomRegisters(const size_t count) {
+        std::vector<uint16_t> registers(count);
+        uint32_t state = 0x12345678;
+        for (uint16_t &value: registers) {
+            state = state * 1664525u + 1013904223u;
+            value = static_cast<uint16_t>(state >> 16);
+        }
+        return registers;
+    }
+
+    /** compares bit patterns, NaNs of float and double included */
+    template<typename T>
+    std::vector<detail::UnsignedOfSize<sizeof(T)> > bits(const std::vector<T> &values) {
+        std::vector<detail::UnsignedOfSize<sizeof(T)> > result;
+        for (const T value: values)
+            result.push_back(std::bit_cast<detail::UnsignedOfSize<sizeof(T)> >(value));
+        return result;
+    }
+
+    template<typename T, WordOrder Order>
+    void expectBulkMatchesScalar() {
+        constexpr size_t Words = sizeof(T) / 2;
+        for (const size_t count: Counts) {
+            SCOPED_TRACE(testing::Message() << "order " << static_cast<int>(Order) << ", " << count << " values");
+            const std::vector<uint16_t> registers = pseudoRandomRegisters(count * Words);
+
+            std::vector<T> bulk(count);
+            EXPECT_EQ((bulkFromRegisters<T, Order>(registers, bulk)), count);
+            std::vector<T> scalar(count);
+            for (size_t i = 0; i < count; ++i)
+                scalar[i] = detail::fromWords<T, Order>(registers.data() + i * Words);
+            EXPECT_EQ(bits(bulk), bits(scalar));
+
+            std::vector<uint16_t> encoded(count * Words);
+            EXPECT_EQ((bulkToRegisters<T, Order>(std::span<const T>(scalar), encoded)), count);
+            std::vector<uint16_t> expected(count * Words);
+            for (size_t i = 0; i < count; ++i)
+                detail::toWords<T, Order>(scalar[i], expected.data() + i * Words);
+            EXPECT_EQ(encoded, expected);
+            EXPECT_EQ(encoded, registers);
+        }
+    }
+
+    template<typename T>
+    void expectBulkMatchesScalarInEveryOrder() {
+        expectBulkMatchesScalar<T, WordOrder::ABCD>();
+        expectBulkMatchesScalar<T, WordOrder::CDAB>();
+        expectBulkMatchesScalar<T, WordOrder::BADC>();
+        expectBulkMatchesScalar<T, WordOrder::DCBA>();
+    }
+}
+
+template<typename T>
+class BulkConvert : public testing::Test {
+};
+
+using BulkConvertTypes = testing::Types<int16_t, uint16_t, int32_t, uint32_t, float, int64_t, uint64_t, double>;
+TYPED_TEST_SUITE(BulkConvert, BulkConvertTypes);
+
+TYPED_TEST(BulkConvert, MatchesScalarConversion) {
+    expectBulkMatchesScalarInEveryOrder<TypeParam>();
+}
+
+TEST(BulkConvertKnownValue, FloatInEveryOrder) {
+    // 123.456f is 0x42F6E979; 9 values are two SIMD blocks and a tail
+    constexpr size_t Count = 9;
+    const std::vector<float> expected(Count, 123.456f);
+    const auto decode = [&]<WordOrder Order>(const std::array<uint16_t, 2> value) {
+        std::vector<uint16_t> registers;
+        for (size_t i = 0; i < Count; ++i)
+            registers.insert(registers.end(), value.begin(), value.end());
+        std::vector<float> values(Count);
+        bulkFromRegisters<float, Order>(registers, std::span(values));
+        return values;
+    };
+
+    EXPECT_EQ(decode.operator()<WordOrder::ABCD>({0x42F6, 0xE979}), expected);
+    EXPECT_EQ(decode.operator()<WordOrder::CDAB>({0xE979, 0x42F6}), expected);
+    EXPECT_EQ(decode.operator()<WordOrder::BADC>({0xF642, 0x79E9}), expected);
+    EXPECT_EQ(decode.operator()<WordOrder::DCBA>({0x79E9, 0xF642}), expected);
+
+    std::vector<uint16_t> registers(2 * Count);
+    bulkToRegisters<float, WordOrder::CDAB>(std::span<const float>(expected), registers);
+    for (size_t i = 0; i < Count; ++i) {
+        EXPECT_EQ(registers[2 * i], 0xE979);
+        EXPECT_EQ(registers[2 * i + 1], 0x42F6);
+    }
+}
@@ -0,0 +1,27 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "ModbusMasterBase.hpp"
+
+using namespace eModbus;
+
+TEST(MasterBaseException, CaughtAsRuntimeError) {
+    EXPECT_THROW(throw MasterBase::ModbusException(Frame::IllegalDataAddress), std::runtime_error);
+    EXPECT_THROW(throw MasterBase::StreamDeviceFailure(SerialError::TIMEOUT), std::runtime_error);
+}
+
+TEST(MasterBaseException, CallerMessageIsTakenAsIs) {
+    const std::string message = "100% of " + std::string(100, 'x') + " %s %n";
+    EXPECT_EQ(std::string(MasterBase::Exception(message).what()), message);
+    EXPECT_EQ(std::string(MasterBase::Exception(message.c_str()).what()), message);
+}
+
+TEST(MasterBaseException, LibraryMessages) {
+    EXPECT_STREQ(MasterBase::ModbusException(Frame::IllegalDataAddress).what(), "Modbus Exception Code 2");
+    EXPECT_STREQ(MasterBase::StreamDeviceFailure(SerialError::TIMEOUT).what(), "Stream Failure Code:TIMEOUT");
+}
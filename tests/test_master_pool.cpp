@@ -0,0 +1,128 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <chrono>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "ModbusMasterPool.hpp"
+
+using namespace eModbus;
+
+namespace {
+    /**
+     * Loopback listener whose accept queue is full, so the next SYN is dropped and a connect to it hangs
+     * like one to a host that is down, without leaving the machine.
+     */
+    class BlackholeEndpoint {
+    public:
+        BlackholeEndpoint() {
+            listener_ = ::socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(address);
+            if (::bind(listener_, reinterpret_cast<sockaddr *>(&address), length) != 0 || ::listen(listener_, 0) != 0
+                || ::getsockname(listener_, reinterpret_cast<sockaddr *>(&address), &length) != 0)
+                return;
+            port_ = ntohs(address.sin_port);
+
+            // fill the queue until a connect stops completing
+            for (int attempt = 0; attempt < 8; ++attempt) {
+                const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+                clients_.push_back(fd);
+                ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+                pollfd pending{fd, POLLOUT, 0};
+                if (::poll(&pending, 1, 100) == 0) {
+                    blackholed_ = true;
+                    return;
+                }
+            }
+        }
+
+        ~BlackholeEndpoint() {
+            for (const int fd: clients_)
+                ::close(fd);
+            if (listener_ >= 0)
+                ::close(listener_);
+        }
+
+        bool blackholed() const {
+            return blackholed_;
+        }
+
+        MasterPool::Endpoint endpoint() const {
+            return {"127.0.0.1", port_};
+        }
+
+    private:
+        int listener_ = -1;
+        uint16_t port_ = 0;
+        bool blackholed_ = false;
+        std::vector<int> clients_;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    std::chrono::milliseconds since(const Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+    }
+}
+
+TEST(MasterPool, QueuedRequestTimesOutWhileConnecting) {
+    const BlackholeEndpoint blackhole;
+    if (!blackhole.blackholed())
+        GTEST_SKIP() << "loopback accept queue did not fill up";
+
+    MasterPool pool;
+    pool.connectTimeout_ms = 10000;
+    const MasterPool::ConnectionID connection = pool.addEndpoint(blackhole.endpoint());
+
+    SerialError result = SerialError::SUCCESS;
+    size_t calls = 0;
+    const Clock::time_point start = Clock::now();
+    pool.read(connection, 1, RegisterType::Holding, 0, 1, [&](const SerialError error, Frame &) {
+        result = error;
+        ++calls;
+    }, 100);
+    while (calls == 0 && since(start) < std::chrono::seconds(5))
+        pool.poll(1000);
+
+    EXPECT_EQ(calls, 1u);
+    EXPECT_EQ(result, SerialError::TIMEOUT);
+    // the loop woke up for the queued deadline instead of sleeping through poll()'s timeout
+    EXPECT_LT(since(start), std::chrono::milliseconds(900));
+    EXPECT_EQ(pool.pending(), 0u);
+}
+
+TEST(MasterPool, ConnectTimeoutFailsQueuedRequests) {
+    const BlackholeEndpoint blackhole;
+    if (!blackhole.blackholed())
+        GTEST_SKIP() << "loopback accept queue did not fill up";
+
+    MasterPool pool;
+    pool.connectTimeout_ms = 200;
+    const MasterPool::ConnectionID connection = pool.addEndpoint(blackhole.endpoint());
+
+    std::vector<SerialError> results;
+    const Clock::time_point start = Clock::now();
+    for (uint16_t address = 0; address < 3; ++address)
+        pool.read(connection, 1, RegisterType::Holding, address, 1, [&](const SerialError error, Frame &) {
+            results.push_back(error);
+        }, 60000);
+    while (pool.pending() != 0 && since(start) < std::chrono::seconds(5))
+        pool.poll(1000);
+
+    ASSERT_EQ(results.size(), 3u);
+    for (const SerialError error: results)
+        EXPECT_EQ(error, SerialError::TIMEOUT);
+    EXPECT_GE(since(start), std::chrono::milliseconds(200));
+    EXPECT_LT(since(start), std::chrono::milliseconds(1500));
+}
@@ -0,0 +1,23 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <gtest/gtest.h>
+
+#include "ModbusMetrics.hpp"
+
+using namespace eModbus;
+
+TEST(Metrics, GatewayUnitIDsHaveTheirOwnCounters) {
+    Metrics metrics;
+    metrics.count(Metrics::Counter::Timeouts, 255, 3);
+    metrics.count(Metrics::Counter::Timeouts, 255, 3);
+    metrics.count(Metrics::Counter::Timeouts, 7, 3);
+
+    const Metrics::Snapshot snapshot = metrics.snapshot();
+    ASSERT_EQ(snapshot.slaves.size(), 2u);
+    const auto timeouts = static_cast<size_t>(Metrics::Counter::Timeouts);
+    EXPECT_EQ(snapshot.slaves[0].first, 7);
+    EXPECT_EQ(snapshot.slaves[0].second.counters[timeouts], 1u);
+    EXPECT_EQ(snapshot.slaves[1].first, 255);
+    EXPECT_EQ(snapshot.slaves[1].second.counters[timeouts], 2u);
+}
@@ -0,0 +1,98 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ModbusMasterTag.hpp"
+#include "ModbusSimulatedBus.hpp"
+#include "TestTags.hpp"
+
+using namespace eModbus;
+using test::holdingTag;
+
+namespace {
+    /** RTU master on a simulated bus, the scheduler running on the bus's virtual clock */
+    struct SimulatedMaster {
+        SimulatedBus bus{19200};
+        SimulatedSlave &slave = bus.addSlave(3, 19200);
+        MasterTag master = MasterTag::RTU(bus);
+
+        SimulatedMaster() {
+            for (uint16_t address = 0; address < 100; ++address)
+                slave.fill(RegisterType::Holding, address, 1, static_cast<uint16_t>(1000 + address));
+            master.readPlanner.costModel = ReadCostModel::RTU(19200);
+            master.polling.now_us = [this] { return bus.clock().now_us(); };
+            master.polling.sleepUntil_us = [this](const uint64_t time_us) { bus.clock().advanceTo(time_us); };
+        }
+
+        PollScheduler::GroupID addGroup(const std::vector<std::string> &keys, const uint32_t period_us,
+                                        const uint8_t priority = 0) {
+            PollScheduler::Group group;
+            group.slaveID = 3;
+            group.tags = master.handles(keys);
+            group.period_us = period_us;
+            group.priority = priority;
+            return master.polling.addGroup(std::move(group));
+        }
+    };
+}
+
+TEST(PollScheduler, FailedRequestOnlyErrorsGroupsWithTagsInIt) {
+    SimulatedMaster simulated;
+    // "missing" is far from the rest, so it gets a request of its own, and the slave has no register 900
+    simulated.master.registerTags({holdingTag("a", 0), holdingTag("b", 1), holdingTag("c", 2), holdingTag("missing", 900)});
+    const PollScheduler::GroupID healthy = simulated.addGroup({"a", "b"}, 100000);
+    const PollScheduler::GroupID broken = simulated.addGroup({"c", "missing"}, 100000);
+
+    std::map<PollScheduler::Handle, uint16_t> values;
+    std::vector<PollScheduler::GroupID> failed;
+    simulated.master.polling.onUpdate([&](uint8_t, const PollScheduler::Handle tag,
+                                          const std::span<const uint16_t> registers) {
+        values[tag] = registers[0];
+    });
+    simulated.master.polling.onError([&](const PollScheduler::GroupID group, const std::exception &) {
+        failed.push_back(group);
+    });
+
+    ASSERT_EQ(simulated.master.polling.pollOnce(simulated.master), 2u);
+
+    const MasterTag &master = simulated.master;
+    EXPECT_EQ(values[master.handle("a")], 1000);
+    EXPECT_EQ(values[master.handle("b")], 1001);
+    // the broken group keeps the tags that were read
+    EXPECT_EQ(values[master.handle("c")], 1002);
+    EXPECT_FALSE(values.contains(master.handle("missing")));
+    EXPECT_EQ(failed, std::vector{broken});
+    EXPECT_EQ(master.polling.statistics(healthy).errors, 0u);
+    EXPECT_EQ(master.polling.statistics(broken).errors, 1u);
+}
+
+TEST(PollScheduler, StretchesLowPriorityPeriodsUnderOverload) {
+    SimulatedMaster simulated;
+    std::vector<Tag> tags;
+    std::vector<std::string> alarms, bulk;
+    for (uint16_t number = 0; number < 100; number += 2) {
+        tags.push_back(holdingTag("t" + std::to_string(number), number));
+        (number < 4 ? alarms : bulk).push_back(tags.back().key);
+    }
+    simulated.master.registerTags(tags);
+    const PollScheduler::GroupID alarm = simulated.addGroup(alarms, 100000, 0);
+    // ~120 ms of bus time every 50 ms, more than the bus has
+    const PollScheduler::GroupID heavy = simulated.addGroup(bulk, 50000, 3);
+
+    simulated.master.polling.onUpdate([&](uint8_t, PollScheduler::Handle, std::span<const uint16_t>) {
+        if (simulated.bus.clock().now_us() > 10000000)
+            simulated.master.stopPolling();
+    });
+    simulated.master.runPolling();
+
+    const PollScheduler &polling = simulated.master.polling;
+    EXPECT_EQ(polling.statistics(alarm).effectivePeriod_us, 100000u);
+    EXPECT_GT(polling.statistics(heavy).effectivePeriod_us, 50000u);
+    EXPECT_LE(polling.statistics(heavy).effectivePeriod_us, 50000u * 16);
+    EXPECT_GT(polling.utilization(), polling.targetUtilization);
+}
@@ -0,0 +1,90 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ModbusMasterTag.hpp"
+#include "ModbusMemory.hpp"
+#include "ModbusSimulatedBus.hpp"
+#include "TestTags.hpp"
+
+using namespace eModbus;
+using test::holdingTag;
+using test::holdingTags;
+
+TEST(ReadPlanCache, ReusesPlanOfSameTagSet) {
+    SimulatedBus bus;
+    MasterTag master = MasterTag::RTU(bus);
+    master.registerTags(holdingTags(8));
+    const std::vector<MasterTag::TagHandle> tags{1, 2, 5};
+
+    const ReadPlan &plan = master.readPlan(1, tags);
+    EXPECT_EQ(&master.readPlan(1, tags), &plan);
+    EXPECT_NE(&master.readPlan(2, tags), &plan);
+    EXPECT_EQ(master.cachedPlansCount(), 2u);
+}
+
+TEST(ReadPlanCache, EvictsLeastRecentlyUsedPlan) {
+    SimulatedBus bus;
+    MasterTag master = MasterTag::RTU(bus);
+    master.registerTags(holdingTags(32));
+    master.planCacheCapacity = 4;
+
+    const std::vector<MasterTag::TagHandle> kept{0};
+    const ReadPlan &plan = master.readPlan(1, kept);
+    for (MasterTag::TagHandle tag = 1; tag < 32; ++tag) {
+        const std::vector<MasterTag::TagHandle> single{tag};
+        master.readPlan(1, single);
+        // used all the time, so it never becomes the least recently used one
+        EXPECT_EQ(&master.readPlan(1, kept), &plan);
+        EXPECT_LE(master.cachedPlansCount(), 4u);
+    }
+}
+
+TEST(MasterTagRead, ReadByTagReferencesReturnsOneBufferPerRequest) {
+    SimulatedBus bus;
+    SimulatedSlave &slave = bus.addSlave(1, 9600);
+    for (uint16_t address = 0; address < 8; ++address)
+        slave.fill(RegisterType::Holding, address, 1, static_cast<uint16_t>(100 + address));
+    slave.fill(RegisterType::Holding, 200, 1, 300);
+    MasterTag master = MasterTag::RTU(bus);
+
+    std::vector<Tag> tags = holdingTags(3);
+    tags.push_back(holdingTag("t200", 200));
+    std::vector<MasterTag::TagRef> references(tags.begin(), tags.end());
+
+    std::vector<RegisterBuffer> buffers = master.read(1, references);
+    ASSERT_EQ(buffers.size(), 2u);
+    EXPECT_EQ(buffers[0].view().get<uint16_t>(2), 102);
+    EXPECT_EQ(buffers[1].view().get<uint16_t>(200), 300);
+}
+
+TEST(MasterTagRead, PmrReadKeepsSlotsOfFailedRequests) {
+    SimulatedBus bus;
+    SimulatedSlave &slave = bus.addSlave(1, 9600);
+    for (uint16_t address = 0; address < 3; ++address)
+        slave.fill(RegisterType::Holding, address, 1, static_cast<uint16_t>(100 + address));
+    slave.fill(RegisterType::Holding, 200, 1, 300);
+    CountingMemoryResource masterResource;
+    MasterTag master = MasterTag::RTU(bus, &masterResource);
+
+    // register 100 is not mapped, its request is answered with an exception
+    std::vector<Tag> tags = holdingTags(3);
+    tags.push_back(holdingTag("gap", 100));
+    tags.push_back(holdingTag("last", 200));
+    master.registerTags(tags);
+    std::vector<MasterTag::TagID> ids{"t0", "t1", "t2", "gap", "last"};
+
+    std::pmr::monotonic_buffer_resource resource;
+    std::pmr::vector<Frame::ExceptionCode> statuses(&resource);
+    const std::pmr::vector<uint16_t> values = master.read(1, ids, &resource, &statuses);
+    EXPECT_EQ(std::vector<uint16_t>(values.begin(), values.end()), (std::vector<uint16_t>{100, 101, 102, 0, 300}));
+    EXPECT_EQ(std::vector<Frame::ExceptionCode>(statuses.begin(), statuses.end()),
+              (std::vector<Frame::ExceptionCode>{Frame::ExceptionCode{}, Frame::IllegalDataAddress,
+                                                  Frame::ExceptionCode{}}));
+    // the detected baud rate went into the map backed by the resource given to the factory
+    EXPECT_GT(masterResource.statistics().allocations, 0u);
+}
@@ -0,0 +1,119 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ModbusMasterTag.hpp"
+#include "ModbusReadPlanner.hpp"
+#include "ModbusSimulatedBus.hpp"
+#include "TestTags.hpp"
+
+using namespace eModbus;
+
+namespace {
+    std::vector<ReadRequest> plan(const ReadCostModel &model, const std::vector<ReadItem> &items,
+                                  const ReadPlanner::ExcludedRegisters &excluded = {}) {
+        ReadPlanner planner;
+        planner.costModel = model;
+        std::vector<ReadRequest> requests;
+        planner.plan(items, excluded, requests);
+        return requests;
+    }
+
+    /** two holding registers with a gap of `gap` registers between them */
+    std::vector<ReadItem> gapped(const uint16_t gap) {
+        return {{RegisterType::Holding, 10, 1}, {RegisterType::Holding, static_cast<uint16_t>(11 + gap), 1}};
+    }
+
+    void expectRequest(const ReadRequest &request, const uint16_t startAddress, const uint16_t quantity) {
+        EXPECT_EQ(request.registerType, RegisterType::Holding);
+        EXPECT_EQ(request.startAddress, startAddress);
+        EXPECT_EQ(request.quantity, quantity);
+    }
+}
+
+TEST(ReadPlanner, BridgesSmallGapOnSlowLine) {
+    const std::vector<ReadRequest> requests = plan(ReadCostModel::RTU(9600), gapped(3));
+    ASSERT_EQ(requests.size(), 1u);
+    expectRequest(requests[0], 10, 5);
+}
+
+TEST(ReadPlanner, SplitsAtLargeGapOnSlowLine) {
+    const std::vector<ReadRequest> requests = plan(ReadCostModel::RTU(9600), gapped(50));
+    ASSERT_EQ(requests.size(), 2u);
+    expectRequest(requests[0], 10, 1);
+    expectRequest(requests[1], 61, 1);
+}
+
+TEST(ReadPlanner, BridgesLargeGapOverTcp) {
+    const std::vector<ReadRequest> requests = plan(ReadCostModel::TCP(), gapped(50));
+    ASSERT_EQ(requests.size(), 1u);
+    expectRequest(requests[0], 10, 52);
+}
+
+TEST(ReadPlanner, NeverBridgesExcludedRegisters) {
+    ReadPlanner::ExcludedRegisters excluded;
+    excluded[static_cast<size_t>(RegisterType::Holding)] = {30};
+    const std::vector<ReadRequest> requests = plan(ReadCostModel::TCP(), gapped(50), excluded);
+    ASSERT_EQ(requests.size(), 2u);
+    expectRequest(requests[0], 10, 1);
+    expectRequest(requests[1], 61, 1);
+}
+
+TEST(ReadPlanner, ReadsExcludedRegisterOfTagItself) {
+    ReadPlanner::ExcludedRegisters excluded;
+    excluded[static_cast<size_t>(RegisterType::Holding)] = {10};
+    const std::vector<ReadRequest> requests = plan(ReadCostModel::TCP(), {{RegisterType::Holding, 10, 2}}, excluded);
+    ASSERT_EQ(requests.size(), 1u);
+    expectRequest(requests[0], 10, 2);
+}
+
+TEST(ReadPlanner, SplitsAtMaxQuantityAndRegisterType) {
+    std::vector<ReadItem> items;
+    for (uint16_t number = 0; number < 200; ++number)
+        items.push_back({RegisterType::Holding, number, 1});
+    items.insert(items.begin(), {RegisterType::Coil, 0, 1});
+    const std::vector<ReadRequest> requests = plan(ReadCostModel::TCP(), items);
+    ASSERT_EQ(requests.size(), 3u);
+    EXPECT_EQ(requests[0].registerType, RegisterType::Coil);
+    EXPECT_EQ(requests[1].quantity + requests[2].quantity, 200);
+    EXPECT_LE(requests[1].quantity, MAX_MODBUS_REGISTERS);
+    EXPECT_LE(requests[2].quantity, MAX_MODBUS_REGISTERS);
+}
+
+TEST(MasterTagCostModel, TcpMasterMovesBytesForFree) {
+    SimulatedBus bus;
+    const MasterTag master = MasterTag::TCP(bus);
+    EXPECT_EQ(master.costModel().baudrate, 0u);
+    EXPECT_EQ(master.costModel(1).baudrate, 0u);
+}
+
+TEST(MasterTagCostModel, RtuMasterUsesDetectedBaudrate) {
+    SimulatedBus bus(9600);
+    bus.addSlave(1, 19200).fill(RegisterType::Holding, 0, 1, 0);
+    MasterTag master = MasterTag::RTU(bus);
+    EXPECT_EQ(master.costModel(1).baudrate, 9600u);
+
+    master.MasterBase::read(1, RegisterType::Holding, 0, 1);
+    EXPECT_EQ(master.costModel(1).baudrate, 19200u);
+
+    master.costModelFromBus = false;
+    master.readPlanner.costModel = ReadCostModel::TCP();
+    EXPECT_EQ(master.costModel(1).baudrate, 0u);
+}
+
+TEST(MasterTagCostModel, PlanFollowsTheBus) {
+    SimulatedBus bus;
+    const std::vector<Tag> tags{test::holdingTag("low", 10), test::holdingTag("high", 61)};
+    const std::vector<MasterTag::TagHandle> handles{0, 1};
+
+    MasterTag tcp = MasterTag::TCP(bus);
+    tcp.registerTags(tags);
+    EXPECT_EQ(tcp.readPlan(1, handles).requests().size(), 1u);
+
+    MasterTag rtu = MasterTag::RTU(bus);
+    rtu.registerTags(tags);
+    EXPECT_EQ(rtu.readPlan(1, handles).requests().size(), 2u);
+}
@@ -0,0 +1,33 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <array>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "ModbusRegisterSnapshot.hpp"
+
+using namespace eModbus;
+
+TEST(SnapshotRegisterBuffer, GetReadsWholeValue) {
+    SnapshotRegisterBuffer snapshot(100, RegisterType::Holding, 2);
+    std::array<uint16_t, 2> registers{};
+    convertToRegisters<float>(registers, 12.5f);
+    snapshot.publish(100, registers);
+
+    EXPECT_EQ(snapshot.get<float>(100), 12.5f);
+    EXPECT_EQ(snapshot.get<uint16_t>(101), registers[1]);
+}
+
+TEST(SnapshotRegisterBuffer, GetPastTheBlockThrows) {
+    SnapshotRegisterBuffer snapshot(100, RegisterType::Holding, 2);
+    const std::array<uint16_t, 2> registers{0x4148, 0x0000};
+    snapshot.publish(100, registers);
+
+    // the second half of the float would be past the block
+    EXPECT_THROW(snapshot.get<float>(101), std::out_of_range);
+    EXPECT_THROW(snapshot.get<uint32_t>(101), std::out_of_range);
+    EXPECT_THROW(snapshot.get<uint16_t>(102), std::out_of_range);
+    EXPECT_THROW(snapshot.get<uint16_t>(99), std::out_of_range);
+}
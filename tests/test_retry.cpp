@@ -0,0 +1,91 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ModbusMasterBase.hpp"
+#include "ModbusSimulatedBus.hpp"
+
+using namespace eModbus;
+
+namespace {
+    /** records how the master waits */
+    class WaitRecordingBus : public SimulatedBus {
+    public:
+        using SimulatedBus::SimulatedBus;
+
+        std::vector<uint32_t> delays;
+        std::vector<uint32_t> interFrameDelays;
+
+        void delay(const uint32_t delay_us) override {
+            delays.push_back(delay_us);
+            SimulatedBus::delay(delay_us);
+        }
+
+        void interFrameDelay(const uint32_t delay_us) override {
+            interFrameDelays.push_back(delay_us);
+            SimulatedBus::interFrameDelay(delay_us);
+        }
+    };
+}
+
+TEST(RetryPolicy, BackoffSleepsInsteadOfSpinning) {
+    WaitRecordingBus bus;
+    bus.addSlave(1, 9600).fill(RegisterType::Holding, 0, 1, 0);
+    MasterBase master = MasterBase::RTU(bus);
+    master.retryPolicy.maxAttempts = 3;
+    master.retryPolicy.jitter = 0.0f;
+    // the first read finds the slave's baud rate, from then on it stops answering
+    master.read(1, RegisterType::Holding, 0, 1);
+    bus.dropoutRate = 1.0;
+    bus.delays.clear();
+    bus.interFrameDelays.clear();
+
+    EXPECT_THROW(master.read(1, RegisterType::Holding, 0, 1), MasterBase::StreamDeviceFailure);
+
+    EXPECT_EQ(bus.delays, (std::vector<uint32_t>{5000, 10000}));
+    for (const uint32_t gap: bus.interFrameDelays)
+        EXPECT_LT(gap, 5000u); // t3.5 only
+}
+
+namespace {
+    /** sends and receives through the same frame */
+    class AliasingMaster : public MasterBase {
+    public:
+        explicit AliasingMaster(IStreamDevice &device) : MasterBase(device) {
+        }
+
+        std::vector<uint16_t> readInPlace(const uint8_t slave_ID, const uint16_t start_address,
+                                          const uint16_t quantity) {
+            Frame frame = Frame::build(true, slave_ID, Frame::FunctionCode::ReadHoldingRegisters, start_address,
+                                       quantity);
+            sendReceiveFrame(frame, frame);
+            std::vector<uint16_t> values(frame.registersValuesCount());
+            frame.copyRegistersValues(values);
+            return values;
+        }
+    };
+}
+
+TEST(RetryPolicy, RetriesResendTheRequestWhenResponseAliasesIt) {
+    SimulatedBus bus;
+    bus.addSlave(1, 9600).fill(RegisterType::Holding, 0, 4, 0x1234);
+    AliasingMaster master(bus);
+    master.retryPolicy.maxAttempts = 5;
+    master.retryPolicy.jitter = 0.0f;
+    master.read(1, RegisterType::Holding, 0, 1);
+    bus.crcErrorRate = 0.5;
+
+    int failures = 0;
+    for (int i = 0; i < 200; ++i) {
+        try {
+            EXPECT_EQ(master.readInPlace(1, 0, 4), (std::vector<uint16_t>{0x1234, 0x1234, 0x1234, 0x1234}));
+        } catch (const MasterBase::InvalidFrame &) {
+            ++failures;
+        }
+    }
+    // five attempts at 50 % each: about one read in 32 runs out of them
+    EXPECT_LT(failures, 20);
+}
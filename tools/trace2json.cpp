@@ -0,0 +1,29 @@
+//
+// Created by kdluzynski on 18.10.2026.
+//
+// Offline decoder of eModbus binary traces (eModbus::trace::save) to Chrome/Perfetto trace JSON.
+// usage: eModbus_trace2json trace.bin [trace.json]
+#include <cstdio>
+#include <fstream>
+
+#include "ModbusTrace.hpp"
+
+int main(const int argc, char **argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s trace.bin [trace.json]\n", argv[0]);
+        return 2;
+    }
+    const std::vector<eModbus::trace::ThreadRecord> records = eModbus::trace::load(argv[1]);
+    if (records.empty()) {
+        std::fprintf(stderr, "%s: no trace records\n", argv[1]);
+        return 1;
+    }
+    const std::string json = eModbus::trace::toChromeJson(records);
+    if (argc < 3) {
+        std::fwrite(json.data(), 1, json.size(), stdout);
+        return 0;
+    }
+    std::ofstream out(argv[2], std::ios::trunc);
+    out << json;
+    return out ? 0 : 1;
+}